@@ -0,0 +1,236 @@
+// KT header-only library
+// Requirements: C++17
+//
+// Features:
+// 	- Publish items to hierarchical topics ("orders.eu.fr")
+// 	- Subscribe queues to topic patterns ("orders.eu.*", "orders.#")
+// 	- Shared immutable items (one allocation per publish, regardless of fan-out)
+// 	- Per-topic match cache (publish is a hash lookup after the first match)
+//
+
+#pragma once
+#include "async_queue.hpp"
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace kt {
+///
+/// \brief Topic based publish / subscribe over async_queue
+/// \param T value type
+/// \param Policy queue policy
+///
+/// Topics and patterns are '.' separated segments; in patterns, '*' matches exactly one segment
+/// and a trailing '#' matches zero or more remaining segments.
+///
+template <typename T, typename Policy = async_queue_policy<>>
+class async_pubsub {
+  public:
+	using value_type = T;
+	using item_t = std::shared_ptr<T const>;
+	using queue_type = async_queue<item_t, Policy>;
+	using queue_id = typename queue_type::queue_id;
+
+	///
+	/// \brief Maximum number of topics whose matches are cached (cache is reset when exceeded)
+	///
+	static constexpr std::size_t max_cached_topics = 4096;
+
+	///
+	/// \brief Check whether pattern is well formed ('#' only as the last segment)
+	///
+	static bool valid(std::string_view pattern);
+	///
+	/// \brief Add a new subscriber queue for pattern and obtain its qid
+	/// Throws std::invalid_argument if pattern is not valid()
+	///
+	queue_id subscribe(std::string_view pattern);
+	///
+	/// \brief Subscribe an existing qid to pattern
+	/// Throws std::invalid_argument if pattern is not valid()
+	///
+	void subscribe(std::string_view pattern, queue_id qid);
+	///
+	/// \brief Unsubscribe qid from pattern
+	/// \returns false if qid was not subscribed to pattern
+	///
+	bool unsubscribe(std::string_view pattern, queue_id qid);
+	///
+	/// \brief Publish a T to all subscribers whose patterns match topic
+	/// \returns Number of subscribers the item was delivered to
+	///
+	std::size_t publish(std::string_view topic, T t) { return publish(topic, std::make_shared<T const>(std::move(t))); }
+	///
+	/// \brief Publish a shared item to all subscribers whose patterns match topic
+	/// \returns Number of subscribers the item was delivered to
+	///
+	std::size_t publish(std::string_view topic, item_t item);
+	///
+	/// \brief Pop an item from subscriber queue, wait until populated / not active
+	///
+	std::optional<item_t> pop(queue_id qid) { return m_queue.pop(qid); }
+
+	queue_type& queue() noexcept { return m_queue; }
+	queue_type const& queue() const noexcept { return m_queue; }
+
+  private:
+	struct node_t {
+		std::unordered_map<std::string, std::unique_ptr<node_t>> children;
+		std::unique_ptr<node_t> any;  // '*'
+		std::vector<queue_id> tail;	  // '#' subscribers at this level
+		std::vector<queue_id> exact;  // subscribers whose pattern ends here
+	};
+
+	template <typename F>
+	static void segments(std::string_view str, F&& f);
+	static void match(node_t const& node, std::string_view rest, std::vector<queue_id>& out);
+	std::vector<queue_id>* find(std::string_view pattern, bool create);
+	std::vector<queue_id> const& matches(std::string_view topic);
+	std::size_t deliver(std::vector<queue_id> const& qids, item_t const& item);
+	void invalidate() noexcept;
+
+	queue_type m_queue;
+	node_t m_root;
+	std::unordered_map<std::string_view, std::vector<queue_id>> m_cache; // keys view into m_topics
+	std::deque<std::string> m_topics;
+	mutable std::shared_mutex m_mutex;
+};
+
+template <typename T, typename Policy>
+bool async_pubsub<T, Policy>::valid(std::string_view pattern) {
+	bool ret = true;
+	bool tail = false;
+	segments(pattern, [&](std::string_view segment) {
+		if (tail) { ret = false; }
+		tail = segment == "#";
+	});
+	return ret;
+}
+
+template <typename T, typename Policy>
+typename async_pubsub<T, Policy>::queue_id async_pubsub<T, Policy>::subscribe(std::string_view pattern) {
+	if (!valid(pattern)) { throw std::invalid_argument("'#' must be the last segment of a pattern"); }
+	queue_id const ret = m_queue.add_queue();
+	subscribe(pattern, ret);
+	return ret;
+}
+
+template <typename T, typename Policy>
+void async_pubsub<T, Policy>::subscribe(std::string_view pattern, queue_id qid) {
+	if (!valid(pattern)) { throw std::invalid_argument("'#' must be the last segment of a pattern"); }
+	std::unique_lock lock(m_mutex);
+	auto& subscribers = *find(pattern, true);
+	if (std::find(subscribers.begin(), subscribers.end(), qid) == subscribers.end()) { subscribers.push_back(qid); }
+	invalidate();
+}
+
+template <typename T, typename Policy>
+bool async_pubsub<T, Policy>::unsubscribe(std::string_view pattern, queue_id qid) {
+	std::unique_lock lock(m_mutex);
+	auto* subscribers = find(pattern, false);
+	if (!subscribers) { return false; }
+	auto it = std::find(subscribers->begin(), subscribers->end(), qid);
+	if (it == subscribers->end()) { return false; }
+	subscribers->erase(it);
+	invalidate();
+	return true;
+}
+
+template <typename T, typename Policy>
+std::size_t async_pubsub<T, Policy>::publish(std::string_view topic, item_t item) {
+	{
+		std::shared_lock lock(m_mutex);
+		if (auto it = m_cache.find(topic); it != m_cache.end()) { return deliver(it->second, item); }
+	}
+	std::unique_lock lock(m_mutex);
+	return deliver(matches(topic), item);
+}
+
+template <typename T, typename Policy>
+template <typename F>
+void async_pubsub<T, Policy>::segments(std::string_view str, F&& f) {
+	while (!str.empty()) {
+		auto const dot = str.find('.');
+		f(str.substr(0, dot));
+		if (dot == std::string_view::npos) { break; }
+		str = str.substr(dot + 1);
+	}
+}
+
+template <typename T, typename Policy>
+void async_pubsub<T, Policy>::match(node_t const& node, std::string_view rest, std::vector<queue_id>& out) {
+	out.insert(out.end(), node.tail.begin(), node.tail.end());
+	if (rest.empty()) {
+		out.insert(out.end(), node.exact.begin(), node.exact.end());
+		return;
+	}
+	auto const dot = rest.find('.');
+	std::string_view const segment = rest.substr(0, dot);
+	std::string_view const next = dot == std::string_view::npos ? std::string_view() : rest.substr(dot + 1);
+	if (auto it = node.children.find(std::string(segment)); it != node.children.end()) { match(*it->second, next, out); }
+	if (node.any) { match(*node.any, next, out); }
+}
+
+template <typename T, typename Policy>
+std::vector<typename async_pubsub<T, Policy>::queue_id>* async_pubsub<T, Policy>::find(std::string_view pattern, bool create) {
+	node_t* node = &m_root;
+	bool tail = false;
+	segments(pattern, [&](std::string_view segment) {
+		if (!node || tail) {
+			node = nullptr;
+			return;
+		}
+		if (segment == "#") {
+			tail = true;
+			return;
+		}
+		if (segment == "*") {
+			if (!node->any && create) { node->any = std::make_unique<node_t>(); }
+			node = node->any.get();
+			return;
+		}
+		auto it = node->children.find(std::string(segment));
+		if (it == node->children.end()) {
+			if (!create) {
+				node = nullptr;
+				return;
+			}
+			it = node->children.emplace(std::string(segment), std::make_unique<node_t>()).first;
+		}
+		node = it->second.get();
+	});
+	if (!node) { return nullptr; }
+	return tail ? &node->tail : &node->exact;
+}
+
+template <typename T, typename Policy>
+std::vector<typename async_pubsub<T, Policy>::queue_id> const& async_pubsub<T, Policy>::matches(std::string_view topic) {
+	if (auto it = m_cache.find(topic); it != m_cache.end()) { return it->second; }
+	std::vector<queue_id> qids;
+	match(m_root, topic, qids);
+	std::sort(qids.begin(), qids.end());
+	qids.erase(std::unique(qids.begin(), qids.end()), qids.end());
+	if (m_cache.size() >= max_cached_topics) { invalidate(); }
+	std::string_view const key = m_topics.emplace_back(topic);
+	return m_cache.emplace(key, std::move(qids)).first->second;
+}
+
+template <typename T, typename Policy>
+std::size_t async_pubsub<T, Policy>::deliver(std::vector<queue_id> const& qids, item_t const& item) {
+	for (queue_id qid : qids) { m_queue.push(item, qid); }
+	return qids.size();
+}
+
+template <typename T, typename Policy>
+void async_pubsub<T, Policy>::invalidate() noexcept {
+	m_cache.clear();
+	m_topics.clear();
+}
+} // namespace kt
@@ -7,27 +7,74 @@
 // 	- Thread-safe wait-and-pop (from first of any desired queues)
 // 	- Clear all queues and return residue
 // 	- Deactivate all queues (as secondary wait condition)
+// 	- Nested queue groups (wait-and-pop across a group per priority / round-robin policy)
+// 	- Wait until queues are drained / all items pushed before a barrier are popped
+// 	- In-flight accounting and quiescence detection (all queues empty, no popped items pending done())
+// 	- Earliest-deadline-first order per queue (expired items shed at pop)
+// 	- Item time-to-live per queue (expired items shed at pop / amortized sweep)
+// 	- Remove items by predicate / cancel individual items by handle
+// 	- Splice items between queues / transfer them to another instance (notifies only if target has waiters)
+// 	- Non-destructive peek at the front item / snapshot copies of queue contents
+// 	- Optional global arrival order across queues for pop_any (oldest head first; O(1) selection over registered sets)
+// 	- Byte capacity limits per queue / globally (block, reject, or drop oldest on overflow)
+// 	- Non-blocking try-pop and push readiness callback (eg to signal an eventfd polled by an event loop)
+// 	- Per-queue capacity reserved (and pre-faulted) up front, kept across drains (with a reservable queue_t, eg ring_deque)
+// 	- Exact wakeups: pushing k items wakes at most k blocked consumers (per-waiter handoff, no thundering herd)
+// 	- FIFO (longest parked) or LIFO (most recently parked, cache-warm) choice of consumer to wake
 //
 
 #pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <condition_variable>
+#include <cstdint>
 #include <deque>
+#include <functional>
 #include <iterator>
 #include <mutex>
 #include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace kt {
 ///
 /// \brief Policy customization
+/// \param Storage item container (std::deque, or ring_deque to reserve capacity up front)
 ///
-template <typename M = std::mutex, template <typename> typename Alloc = std::allocator>
+/// Custom policies must provide queue_t and mutex_t; list_t is optional (std::deque if absent).
+///
+template <typename M = std::mutex, template <typename> typename Alloc = std::allocator, template <typename, typename> typename Storage = std::deque>
 struct async_queue_policy {
 	template <typename T>
-	using queue_t = std::deque<T, Alloc<T>>;
+	using queue_t = Storage<T, Alloc<T>>;
+	template <typename T>
+	using list_t = std::deque<T, Alloc<T>>; // per-queue bookkeeping (references must stay stable)
 	using mutex_t = M;
 };
 
+namespace detail {
+template <typename C, typename = void>
+struct has_reserve : std::false_type {};
+template <typename C>
+struct has_reserve<C, std::void_t<decltype(std::declval<C&>().reserve(std::size_t{}))>> : std::true_type {};
+
+template <typename Policy, typename U, typename = void>
+struct policy_list {
+	using type = std::deque<U>;
+};
+template <typename Policy, typename U>
+struct policy_list<Policy, U, std::void_t<typename Policy::template list_t<U>>> {
+	using type = typename Policy::template list_t<U>;
+};
+} // namespace detail
+
 ///
 /// \brief FIFO queue with thread safe "sleepy" API
 /// \param T value type
@@ -40,12 +87,112 @@ class async_queue {
 	using queue_t = typename Policy::template queue_t<T>;
 	using mutex_t = typename Policy::mutex_t;
 
+	///
+	/// \brief Whether capacity can be reserved per queue (queue_t supports reserve(), eg ring_deque)
+	///
+	static constexpr bool reservable = detail::has_reserve<queue_t>::value;
+
 	///
 	/// \brief Queue index (used with multiple queues)
 	///
 	using queue_id = std::size_t;
+	///
+	/// \brief Group index (used with queue groups)
+	///
+	using group_id = std::size_t;
+
+	///
+	/// \brief Selection policy across the children of a group
+	///
+	enum class group_policy {
+		priority,	 // first populated child in attach order
+		round_robin, // first populated child after the last selected one
+	};
+
+	///
+	/// \brief Flush barrier: completes once all items pushed before it (to the covered queues) have been popped
+	///
+	struct flush_barrier {
+		std::vector<std::uint64_t> marks; // indexed by qid
+	};
+
+	///
+	/// \brief Handle to a registered set of queues (used with pop_any in arrival order)
+	///
+	struct queue_set {
+		std::size_t index{};
+	};
+
+	using clock = std::chrono::steady_clock;
+	///
+	/// \brief Obtains the deadline of an item (used with deadline ordered queues)
+	///
+	using deadline_fn = std::function<clock::time_point(T const&)>;
+	///
+	/// \brief Receives items shed past their deadline / TTL (invoked under the lock: must not call back into the queue)
+	///
+	using expired_fn = std::function<void(T&&)>;
+
+	///
+	/// \brief Obtains the size of an item in bytes (used with byte limits)
+	///
+	using size_fn = std::function<std::size_t(T const&)>;
+	///
+	/// \brief Receives the qid and count of items pushed (invoked under the lock: must not call back into the queue)
+	///
+	using ready_fn = std::function<void(queue_id, std::size_t)>;
+
+	///
+	/// \brief Behaviour of push when an item does not fit within byte limits
+	///
+	enum class overflow_policy {
+		block,		 // wait until popped items make room
+		reject,		 // discard the pushed item
+		drop_oldest, // pop (and discard) items from the front of the target queue until it fits (reject if that cannot make it fit)
+	};
+
+	///
+	/// \brief Which blocked consumer a push wakes
+	///
+	enum class wake_policy {
+		fifo, // longest parked first
+		lifo, // most recently parked first (keeps a few hot consumers busy, lets the rest sleep)
+	};
+
+	///
+	/// \brief Byte accounting
+	///
+	struct byte_usage {
+		std::size_t used{};		// bytes of queued items
+		std::size_t reserved{}; // bytes of items whose producers are blocked waiting for room
+		std::size_t limit{};	// 0 = unlimited
+	};
 
-	async_queue(std::uint8_t qcount = 1);
+	///
+	/// \brief Handle to a queued item (used to cancel it)
+	///
+	struct item_handle {
+		queue_id qid{};
+		std::uint64_t seq{};
+	};
+
+	///
+	/// \brief Per-queue counters
+	///
+	struct queue_stats {
+		std::uint64_t pushed{};
+		std::uint64_t popped{};
+		std::uint64_t expired{};
+		std::uint64_t removed{}; // by clear() / remove_if() / cancel() / splice() / transfer()
+		std::uint64_t dropped{}; // by overflow_policy::drop_oldest
+		std::uint64_t rejected{};
+	};
+
+	///
+	/// \brief Construct qcount queues, each with capacity reserved (see add_queue())
+	/// capacity > 0 requires a reservable queue_t
+	///
+	async_queue(std::uint8_t qcount = 1, std::size_t capacity = 0);
 	virtual ~async_queue() noexcept { clear(); }
 
 	///
@@ -67,18 +214,157 @@ class async_queue {
 	template <template <typename...> typename Cont, typename... Args>
 	void push(Cont<T, Args...>&& ts, queue_id qid = 0);
 	///
+	/// \brief Move a T to the back of desired queue and notify, if it fits within byte limits (never blocks)
+	/// \returns false if rejected / not active
+	///
+	bool try_push(T&& t, queue_id qid = 0);
+	///
+	/// \brief Move a T to the back of desired queue, notify, and obtain a handle to cancel it (FIFO queues only)
+	///
+	item_handle push_cancellable(T&& t, queue_id qid = 0);
+	///
+	/// \brief Cancel a queued item (it is skipped and destroyed once it reaches the front)
+	/// \returns false if the item has already been popped / removed / cancelled
+	///
+	bool cancel(item_handle const& handle);
+	///
+	/// \brief Remove all items in desired queue that satisfy pred (compacts storage in one pass)
+	/// \param pred Invoked with T const& under the lock; removed items are destroyed after unlocking
+	/// \returns Number of items removed
+	/// Removing items from the middle of a FIFO queue starts tracking its items' push order (for barriers)
+	///
+	template <typename Pred>
+	std::size_t remove_if(queue_id qid, Pred pred);
+	///
+	/// \brief Move up to n items from the front of one queue to the back of another
+	/// \returns Number of items moved (O(1) when all of a plain FIFO queue moves into an empty plain FIFO queue)
+	///
+	std::size_t splice(queue_id from, queue_id to, std::size_t n = std::size_t(-1));
+	///
+	/// \brief Move up to n items from the front of one queue to the back of a queue in another instance
+	/// \returns Number of items moved (0 if dst is not active)
+	///
+	std::size_t transfer(queue_id from, async_queue& dst, queue_id to, std::size_t n = std::size_t(-1));
+	///
 	/// \brief Pop a T from the front of the first non-empty queue, wait until any populated / not active
 	///
 	template <template <typename...> typename Cont, typename... Args>
 	std::optional<T> pop_any(Cont<queue_id, Args...> qids);
 	///
+	/// \brief Pop a T from the front of the set's first non-empty (oldest head, if ordered by arrival) queue, wait until any populated / not active
+	///
+	std::optional<T> pop_any(queue_set set);
+	///
 	/// \brief Pop a T from the front of desired queue, wait until populated / not active
 	///
 	std::optional<T> pop(queue_id qid = 0);
 	///
+	/// \brief Pop a T from the front of the first non-empty queue, if any (never blocks)
+	///
+	template <template <typename...> typename Cont, typename... Args>
+	std::optional<T> try_pop_any(Cont<queue_id, Args...> qids);
+	///
+	/// \brief Pop a T from the front of the set's first non-empty (oldest head, if ordered by arrival) queue, if any (never blocks)
+	///
+	std::optional<T> try_pop_any(queue_set set);
+	///
+	/// \brief Pop a T from the front of desired queue, if any (never blocks)
+	///
+	std::optional<T> try_pop(queue_id qid = 0);
+	///
+	/// \brief Pop a T from the front of the group's selected queue, wait until any populated / not active
+	///
+	std::optional<T> pop_group(group_id gid);
+	///
+	/// \brief Visit the front item of desired queue (if any) without popping it
+	/// \param visitor Invoked with T const& under the lock: must not call back into the queue
+	/// \returns false if queue is empty
+	///
+	template <typename F>
+	bool peek(queue_id qid, F&& visitor);
+	///
+	/// \brief Copy up to n items of desired queue, in pop order
+	///
+	std::vector<T> snapshot(queue_id qid, std::size_t n = std::size_t(-1)) const;
+	///
+	/// \brief Obtain the number of items in desired queue (including expired / cancelled items not yet shed)
+	///
+	std::size_t size(queue_id qid) const;
+	///
 	/// \brief Add a new queue and obtain its qid
+	/// \param capacity Number of items to allocate (and pre-fault) storage for up front; kept across drains
+	/// capacity > 0 requires a reservable queue_t (eg async_queue_policy<std::mutex, std::allocator, ring_deque>): asserted
+	///
+	queue_id add_queue(std::size_t capacity = 0);
+	///
+	/// \brief Add a new queue group (nested in parent, if any) and obtain its gid
+	///
+	group_id add_group(std::string name, group_policy policy = group_policy::priority, std::optional<group_id> parent = std::nullopt);
+	///
+	/// \brief Pop desired queue in earliest-deadline-first order, shedding items whose deadline has passed
+	/// \param deadline Obtains an item's deadline
+	/// \param on_expired Receives shed items (optional)
+	///
+	void order_by_deadline(queue_id qid, deadline_fn deadline, expired_fn on_expired = {});
+	///
+	/// \brief Expire items in desired queue ttl after being pushed (FIFO queues only)
+	/// \param on_expired Receives shed items (optional)
+	///
+	void expire_after(queue_id qid, clock::duration ttl, expired_fn on_expired = {});
+	///
+	/// \brief Make pop_any return the oldest head (by push order) among desired queues, instead of the first non-empty one
+	/// Applies to all queues (none may be deadline ordered); items moved by splice() / transfer() count as arriving then
+	/// Selection over a container of qids scans it (O(qids)); register the qids with make_set() for O(1) selection
+	///
+	void order_by_arrival();
+	///
+	/// \brief Register qids as a set for pop_any / try_pop_any (kept for the lifetime of the instance)
+	/// In arrival order a tournament tree over the set's heads is maintained as they change (O(log qids) per change)
+	///
+	queue_set make_set(std::vector<queue_id> qids);
+	///
+	/// \brief Enable byte accounting and set the global byte limit
+	/// \param size Obtains an item's size (invoked under the lock, on push and pop)
+	/// \param limit Global limit across all queues (0 = unlimited)
+	/// An item larger than a limit is only admitted into an empty queue / instance
+	///
+	void byte_limits(size_fn size, std::size_t limit = 0, overflow_policy overflow = overflow_policy::block);
+	///
+	/// \brief Set the byte limit of desired queue (0 = unlimited; requires byte_limits())
+	///
+	void byte_limit(queue_id qid, std::size_t limit);
+	///
+	/// \brief Obtain byte accounting for desired queue
+	///
+	byte_usage bytes(queue_id qid) const;
 	///
-	queue_id add_queue();
+	/// \brief Obtain byte accounting across all queues
+	///
+	byte_usage bytes() const;
+	///
+	/// \brief Set the callback invoked on every push (replaces any previous one; empty to remove)
+	///
+	void on_ready(ready_fn ready);
+	///
+	/// \brief Set which blocked consumer each pushed item wakes (default: fifo)
+	///
+	void wake_order(wake_policy policy);
+	///
+	/// \brief Shed expired items from all TTL queues and release storage of drained ones
+	///
+	void sweep();
+	///
+	/// \brief Obtain counters for desired queue
+	///
+	queue_stats stats(queue_id qid) const;
+	///
+	/// \brief Attach a queue to a group (detaching it from any previous one)
+	///
+	void attach(queue_id qid, group_id gid);
+	///
+	/// \brief Obtain the gid of a named group
+	///
+	std::optional<group_id> find_group(std::string_view name) const;
 	///
 	/// \brief Flush the queue, notify, and obtain any residual items
 	/// \param active Set m_active after moving items
@@ -90,6 +376,42 @@ class async_queue {
 	///
 	bool empty() const;
 	///
+	/// \brief Wait until desired queue is empty / not active
+	/// \returns true if queue is empty
+	///
+	bool wait_empty(queue_id qid);
+	///
+	/// \brief Wait until all queues are empty / not active
+	/// \returns true if all queues are empty
+	///
+	bool wait_empty();
+	///
+	/// \brief Obtain a barrier covering items pushed to desired queue so far
+	///
+	flush_barrier barrier(queue_id qid) const;
+	///
+	/// \brief Obtain a barrier covering items pushed to all queues so far
+	///
+	flush_barrier barrier() const;
+	///
+	/// \brief Wait until all items covered by barrier have been popped (or cleared) / not active
+	/// \returns true if barrier completed
+	///
+	bool wait(flush_barrier const& fb);
+	///
+	/// \brief Mark popped items as processed (every successful pop counts as in-flight until done)
+	///
+	void done(std::size_t count = 1) noexcept;
+	///
+	/// \brief Obtain the number of popped items not yet marked done
+	///
+	std::int64_t in_flight() const noexcept;
+	///
+	/// \brief Wait until all queues are empty and no items are in flight / not active
+	/// \returns true if quiescent
+	///
+	bool wait_quiescent();
+	///
 	/// \brief Check whether instance is active
 	///
 	bool active() const;
@@ -99,37 +421,200 @@ class async_queue {
 	void active(bool value);
 
   protected:
+	struct child_t {
+		std::size_t index{};
+		bool group{};
+	};
+
+	// a blocked consumer (lives on its stack; registered in the parked lists it waits on)
+	struct waiter_t {
+		std::condition_variable cv;
+		std::uint64_t parked_at{};	  // park order (re-stamped every time the waiter sleeps)
+		std::optional<queue_id> cause; // queue whose item the waiter was signalled for (none: wake_all())
+		bool signalled{};
+	};
+
+	struct group_t {
+		std::string name;
+		std::vector<child_t> children;
+		std::optional<group_id> parent;
+		std::vector<waiter_t*> parked; // pop_group() callers blocked on this group
+		std::size_t populated{};	   // count of non-empty children
+		std::size_t cursor{};
+		group_policy policy{};
+	};
+
+	// padded to avoid false sharing between threads
+	struct alignas(64) shard_t {
+		std::atomic<std::int64_t> count{};
+	};
+
+	struct set_t {
+		std::vector<queue_id> qids;
+		std::vector<std::size_t> tree; // tournament tree over positions in qids (1-based, leaves at [tree.size() / 2, tree.size()))
+	};
+
+	struct info_t {
+		std::optional<group_id> group;
+		queue_stats stats;
+		deadline_fn deadline; // set: queue is a min-heap on deadline
+		expired_fn on_expired;
+		std::optional<clock::duration> ttl;
+		typename Policy::template queue_t<clock::time_point> expiry; // parallel to items, only maintained if ttl is set
+		typename Policy::template queue_t<std::uint64_t> seqs;		 // parallel to items, only maintained if tracked / deadline ordered
+		std::deque<std::uint64_t> departed;							 // deadline ordered: bitmap of seqs that have left, from word low / 64
+		std::uint64_t low{};										 // deadline ordered: every seq below low has left
+		std::unordered_map<std::uint64_t, bool> handles;			 // seq => cancelled
+		typename Policy::template queue_t<std::uint64_t> arrivals;	 // parallel to items, only maintained if m_arrival_order
+		std::vector<waiter_t*> parked;								 // pop_any() callers blocked on this queue
+		std::vector<std::pair<std::size_t, std::size_t>> sets;		 // (set, position) of every set containing this queue
+		byte_usage bytes;
+		std::size_t capacity{}; // items reserved at add_queue()
+		bool tracked{};
+	};
+
 	// MSVC throws random constexpr failures with C++20 if this is defined out-of-line
 	template <template <typename...> typename Cont, typename... Args>
-	bool should_wake(Cont<queue_id, Args...> const& qids, queue_t** out) noexcept {
-		auto check = [this, out](queue_id qid) {
-			queue_t& qu = queue(qid);
-			if (!qu.empty()) {
-				*out = &qu;
+	bool should_wake(Cont<queue_id, Args...> const& qids, queue_id* out) {
+		if (std::empty(qids)) { return check(0, out); }
+		if (m_arrival_order) { return oldest(qids, out); }
+		for (queue_id qid : qids) {
+			if (check(qid, out)) { return true; }
+		}
+		return false;
+	}
+
+	bool should_wake(set_t const& set, queue_id* out) {
+		if (m_arrival_order) { return oldest(set, out); }
+		for (queue_id qid : set.qids) {
+			if (check(qid, out)) { return true; }
+		}
+		return false;
+	}
+
+	bool oldest(set_t const& set, queue_id* out) {
+		// only the winning head has to be live: shed TTL queues lazily
+		for (;;) {
+			std::size_t const pos = set.tree[1];
+			if (head(set, pos) == no_arrival) { return false; }
+			queue_id const qid = set.qids[pos];
+			if (!m_infos[qid].ttl || !expired(qid, clock::now())) {
+				*out = qid;
 				return true;
 			}
-			return false;
-		};
-		if (std::empty(qids)) { return check(0); }
+			shed(qid);
+		}
+	}
+
+	template <typename Cont>
+	bool oldest(Cont const& qids, queue_id* out) {
+		for (queue_id qid : qids) {
+			if (m_infos[qid].ttl) { shed(qid); }
+		}
+		// tournament winner: oldest head across all queues
+		queue_id const top = m_tree[1];
+		if (m_heads[top] == no_arrival) { return false; }
+		std::optional<queue_id> ret;
 		for (queue_id qid : qids) {
-			if (check(qid)) { return true; }
+			if (qid == top) {
+				ret = top;
+				break;
+			}
+			if (m_heads[qid] != no_arrival && (!ret || m_heads[qid] < m_heads[*ret])) { ret = qid; }
+		}
+		if (!ret) { return false; }
+		*out = *ret;
+		return true;
+	}
+
+	bool check(queue_id qid, queue_id* out) {
+		if (m_infos[qid].ttl || m_infos[qid].deadline) { shed(qid); }
+		if (!queue(qid).empty()) {
+			*out = qid;
+			return true;
 		}
 		return false;
 	}
 
+	static void unpark(std::vector<waiter_t*>& parked, waiter_t* waiter) noexcept {
+		parked.erase(std::find(parked.begin(), parked.end(), waiter));
+	}
+
+	template <typename Cont>
+	void watch(Cont const& qids, waiter_t* waiter, bool waiting) {
+		if (std::empty(qids)) {
+			waiting ? m_infos[0].parked.push_back(waiter) : unpark(m_infos[0].parked, waiter);
+			return;
+		}
+		for (queue_id qid : qids) { waiting ? m_infos[qid].parked.push_back(waiter) : unpark(m_infos[qid].parked, waiter); }
+	}
+
+	template <typename Pred>
+	bool wait_drained(Pred pred);
+	template <typename Pred>
+	void park(std::unique_lock<mutex_t>& lock, waiter_t& waiter, Pred wake);
+	void wake(queue_id qid, std::size_t count);
+	void wake_all();
+	void pass_on(waiter_t const& waiter, queue_id taken);
+	static std::size_t move_items(async_queue& src, queue_id from, async_queue& dst, queue_id to, std::size_t n);
+	static bool plain(info_t const& info) noexcept { return !info.deadline && !info.ttl && !info.tracked; }
+	void update_head(queue_id qid) noexcept;
+	void build_tree();
+	std::uint64_t head(set_t const& set, std::size_t pos) const noexcept { return pos < set.qids.size() ? m_heads[set.qids[pos]] : no_arrival; }
+	void update_set(set_t& set, std::size_t pos) noexcept;
+	void build_set(set_t& set);
+	bool fits(queue_id qid, std::size_t size) const noexcept;
+	bool admit(std::unique_lock<mutex_t>& lock, queue_id qid, std::size_t size, bool wait);
+	void charge(queue_id qid, std::size_t size) noexcept;
+	void release(queue_id qid, std::size_t size) noexcept;
+
+	static constexpr std::uint64_t no_arrival = std::uint64_t(-1);
+	static std::size_t shard_index() noexcept;
+	bool select(group_id gid, queue_id* out);
+	void mark(std::optional<group_id> gid, bool populated) noexcept;
+	void on_push(queue_id qid, std::size_t count);
+	void shed(queue_id qid);
+	void skip(queue_id qid);
+	bool expired(queue_id qid, clock::time_point now) const;
+	T pop_front(queue_id qid);
+	T take(queue_id qid);
+	bool passed(queue_id qid, std::uint64_t mark) const noexcept;
+	void depart(info_t& info, std::uint64_t seq);
+	void sift_up(queue_id qid, std::size_t index);
+	void sift_down(queue_id qid, std::size_t index);
+	void heapify(queue_id qid);
+
 	queue_t& queue(queue_id id) noexcept { return m_queues[id]; }
 	queue_t const& queue(queue_id id) const noexcept { return m_queues[id]; }
 
-	typename Policy::template queue_t<queue_t> m_queues;
-	std::condition_variable m_cv;
+	typename detail::policy_list<Policy, queue_t>::type m_queues;
+	typename detail::policy_list<Policy, info_t>::type m_infos;
+	std::vector<group_t> m_groups;
+	std::vector<queue_id> m_ttl_qids;
+	std::size_t m_sweep{};
+	std::vector<std::uint64_t> m_heads; // per qid: arrival of front item (no_arrival if empty)
+	std::vector<queue_id> m_tree;		// tournament tree over m_heads (1-based, leaves at [m_heads.size(), 2 * m_heads.size()))
+	std::deque<set_t> m_sets;			// stable addresses: blocked pop_any callers hold references
+	std::uint64_t m_arrivals{};
+	bool m_arrival_order{};
+	size_fn m_size;
+	ready_fn m_ready;
+	std::uint64_t m_parks{};
+	wake_policy m_wake{};
+	byte_usage m_bytes;
+	overflow_policy m_overflow{};
+	std::condition_variable m_drained_cv;
+	std::size_t m_drain_waiters{};
+	std::array<shard_t, 16> m_in_flight;
+	std::atomic<std::size_t> m_quiescent_waiters{};
 	mutable mutex_t m_mutex;
 	bool m_active = true;
 };
 
 template <typename T, typename Policy>
-async_queue<T, Policy>::async_queue(std::uint8_t qcount) {
+async_queue<T, Policy>::async_queue(std::uint8_t qcount, std::size_t capacity) {
 	if (qcount < 1) { qcount = 1; }
-	for (; qcount > 0; --qcount) { add_queue(); }
+	for (; qcount > 0; --qcount) { add_queue(capacity); }
 }
 
 template <typename T, typename Policy>
@@ -139,40 +624,202 @@ void async_queue<T, Policy>::push(T&& t, queue_id qid) {
 
 template <typename T, typename Policy>
 void async_queue<T, Policy>::push(T const& t, queue_id qid) {
-	emplace<T>(t, qid);
+	emplace<T const&>(t, qid);
 }
 
 template <typename T, typename Policy>
 template <typename... U>
 void async_queue<T, Policy>::emplace(U&&... u, queue_id qid) {
-	{
-		std::scoped_lock lock(m_mutex);
-		if (m_active) { queue(qid).emplace_back(std::forward<U>(u)...); }
+	std::unique_lock lock(m_mutex);
+	if (m_active && !m_size) {
+		queue(qid).emplace_back(std::forward<U>(u)...);
+		on_push(qid, 1);
+	} else if (m_active) {
+		T t(std::forward<U>(u)...);
+		std::size_t const size = m_size(t);
+		if (admit(lock, qid, size, true)) {
+			queue(qid).push_back(std::move(t));
+			charge(qid, size);
+			on_push(qid, 1);
+		}
 	}
-	m_cv.notify_all();
 }
 
 template <typename T, typename Policy>
 template <template <typename...> typename C, typename... Args>
 void async_queue<T, Policy>::push(C<T, Args...>&& ts, queue_id qid) {
+	std::unique_lock lock(m_mutex);
+	if (m_active && !m_size) {
+		std::move(std::begin(ts), std::end(ts), std::back_inserter(queue(qid)));
+		on_push(qid, std::size(ts));
+	} else if (m_active) {
+		// admit items one at a time: a batch larger than the limit must not deadlock
+		for (auto& t : ts) {
+			std::size_t const size = m_size(t);
+			if (!admit(lock, qid, size, true)) {
+				if (!m_active) { break; }
+				continue;
+			}
+			queue(qid).push_back(std::move(t));
+			charge(qid, size);
+			on_push(qid, 1);
+		}
+	}
+}
+
+template <typename T, typename Policy>
+bool async_queue<T, Policy>::try_push(T&& t, queue_id qid) {
+	std::unique_lock lock(m_mutex);
+	if (!m_active) { return false; }
+	std::size_t const size = m_size ? m_size(t) : 0;
+	if (m_size && !admit(lock, qid, size, false)) { return false; }
+	queue(qid).push_back(std::move(t));
+	charge(qid, size);
+	on_push(qid, 1);
+	return true;
+}
+
+template <typename T, typename Policy>
+typename async_queue<T, Policy>::item_handle async_queue<T, Policy>::push_cancellable(T&& t, queue_id qid) {
+	item_handle ret{qid, std::uint64_t(-1)};
+	std::unique_lock lock(m_mutex);
+	info_t& info = m_infos[qid];
+	assert(!info.deadline);
+	queue_t& qu = queue(qid);
+	if (!info.tracked) {
+		// number items already queued below any future seq
+		for (std::size_t i = 0; i < qu.size(); ++i) { info.seqs.push_back(info.stats.pushed - qu.size() + i); }
+		info.tracked = true;
+	}
+	std::size_t const size = m_size ? m_size(t) : 0;
+	if (m_active && (!m_size || admit(lock, qid, size, true))) {
+		ret.seq = info.stats.pushed;
+		qu.push_back(std::move(t));
+		charge(qid, size);
+		info.handles.emplace(ret.seq, false);
+		on_push(qid, 1);
+	}
+	return ret;
+}
+
+template <typename T, typename Policy>
+bool async_queue<T, Policy>::cancel(item_handle const& handle) {
 	{
 		std::scoped_lock lock(m_mutex);
-		if (m_active) { std::move(std::begin(ts), std::end(ts), std::back_inserter(queue(qid))); }
+		info_t& info = m_infos[handle.qid];
+		auto it = info.handles.find(handle.seq);
+		if (it == info.handles.end() || it->second) { return false; }
+		it->second = true;
+		skip(handle.qid);
 	}
-	m_cv.notify_all();
+	m_drained_cv.notify_all();
+	return true;
+}
+
+template <typename T, typename Policy>
+template <typename Pred>
+std::size_t async_queue<T, Policy>::remove_if(queue_id qid, Pred pred) {
+	std::vector<T> removed;
+	std::size_t ret{};
+	{
+		std::scoped_lock lock(m_mutex);
+		queue_t& qu = queue(qid);
+		info_t& info = m_infos[qid];
+		bool const tracked = info.tracked;
+		bool const parallel = tracked || info.deadline;
+		// removing an item behind a kept one breaks the contiguity of an untracked FIFO queue's seqs: number them
+		bool const number = !tracked && !info.deadline;
+		std::uint64_t const base = info.stats.pushed - qu.size();
+		std::size_t out{};
+		for (std::size_t in = 0; in < qu.size(); ++in) {
+			bool drop = pred(std::as_const(qu[in]));
+			if (drop) { ++ret; }
+			if (number && drop && out > 0 && !info.tracked) {
+				// every item kept so far is contiguous (only a prefix was dropped before this one)
+				for (std::size_t i = in - out; i < in; ++i) { info.seqs.push_back(base + i); }
+				info.tracked = true;
+			}
+			if (tracked) {
+				// compact cancelled items out in the same pass
+				if (auto it = info.handles.find(info.seqs[in]); it != info.handles.end() && (drop || it->second)) {
+					drop = true;
+					info.handles.erase(it);
+				}
+			}
+			if (drop) {
+				if (m_size) { release(qid, m_size(qu[in])); }
+				if (info.deadline) { depart(info, info.seqs[in]); }
+				removed.push_back(std::move(qu[in]));
+				continue;
+			}
+			if (number && info.tracked) { info.seqs.push_back(base + in); }
+			if (out != in) {
+				if (parallel) { info.seqs[out] = info.seqs[in]; }
+				qu[out] = std::move(qu[in]);
+				if (info.ttl) { info.expiry[out] = info.expiry[in]; }
+				if (m_arrival_order) { info.arrivals[out] = info.arrivals[in]; }
+			}
+			++out;
+		}
+		if (removed.empty()) { return 0; }
+		qu.erase(qu.begin() + static_cast<std::ptrdiff_t>(out), qu.end());
+		if (info.ttl) { info.expiry.resize(out); }
+		if (info.tracked || info.deadline) { info.seqs.resize(out); }
+		if (m_arrival_order) {
+			info.arrivals.resize(out);
+			update_head(qid);
+		}
+		if (info.deadline) { heapify(qid); }
+		info.stats.removed += removed.size();
+		if (qu.empty()) { mark(info.group, false); }
+	}
+	m_drained_cv.notify_all();
+	return ret;
+}
+
+template <typename T, typename Policy>
+std::size_t async_queue<T, Policy>::splice(queue_id from, queue_id to, std::size_t n) {
+	return move_items(*this, from, *this, to, n);
+}
+
+template <typename T, typename Policy>
+std::size_t async_queue<T, Policy>::transfer(queue_id from, async_queue& dst, queue_id to, std::size_t n) {
+	return move_items(*this, from, dst, to, n);
 }
 
 template <typename T, typename Policy>
 template <template <typename...> typename Cont, typename... Args>
 std::optional<T> async_queue<T, Policy>::pop_any(Cont<queue_id, Args...> qids) {
-	queue_t* queue{};
+	queue_id qid{};
 	std::unique_lock lock(m_mutex);
-	m_cv.wait(lock, [qs = std::move(qids), this, &queue]() -> bool { return !m_active || should_wake(qs, &queue); });
+	auto const wake = [&qids, this, &qid]() -> bool { return !m_active || should_wake(qids, &qid); };
+	if (!wake()) {
+		waiter_t waiter;
+		watch(qids, &waiter, true);
+		park(lock, waiter, wake);
+		watch(qids, &waiter, false);
+		if (m_active) { pass_on(waiter, qid); }
+	}
 	if (!m_active) { return std::nullopt; }
-	assert(queue && !queue->empty());
-	auto ret = std::move(queue->front());
-	queue->pop_front();
-	return ret;
+	return take(qid);
+}
+
+template <typename T, typename Policy>
+std::optional<T> async_queue<T, Policy>::pop_any(queue_set set) {
+	queue_id qid{};
+	std::unique_lock lock(m_mutex);
+	assert(set.index < m_sets.size());
+	set_t const& qset = m_sets[set.index];
+	auto const wake = [&qset, this, &qid]() -> bool { return !m_active || should_wake(qset, &qid); };
+	if (!wake()) {
+		waiter_t waiter;
+		watch(qset.qids, &waiter, true);
+		park(lock, waiter, wake);
+		watch(qset.qids, &waiter, false);
+		if (m_active) { pass_on(waiter, qid); }
+	}
+	if (!m_active) { return std::nullopt; }
+	return take(qid);
 }
 
 template <typename T, typename Policy>
@@ -182,24 +829,338 @@ std::optional<T> async_queue<T, Policy>::pop(queue_id qid) {
 }
 
 template <typename T, typename Policy>
-typename async_queue<T, Policy>::queue_id async_queue<T, Policy>::add_queue() {
+template <template <typename...> typename Cont, typename... Args>
+std::optional<T> async_queue<T, Policy>::try_pop_any(Cont<queue_id, Args...> qids) {
+	queue_id qid{};
 	std::scoped_lock lock(m_mutex);
-	m_queues.emplace_back();
+	if (!m_active || !should_wake(qids, &qid)) { return std::nullopt; }
+	return take(qid);
+}
+
+template <typename T, typename Policy>
+std::optional<T> async_queue<T, Policy>::try_pop_any(queue_set set) {
+	queue_id qid{};
+	std::scoped_lock lock(m_mutex);
+	assert(set.index < m_sets.size());
+	if (!m_active || !should_wake(m_sets[set.index], &qid)) { return std::nullopt; }
+	return take(qid);
+}
+
+template <typename T, typename Policy>
+std::optional<T> async_queue<T, Policy>::try_pop(queue_id qid) {
+	std::initializer_list<queue_id> qids = {qid};
+	return try_pop_any(qids);
+}
+
+template <typename T, typename Policy>
+std::optional<T> async_queue<T, Policy>::pop_group(group_id gid) {
+	queue_id qid{};
+	std::unique_lock lock(m_mutex);
+	assert(gid < m_groups.size());
+	auto const wake = [gid, this, &qid]() -> bool { return !m_active || select(gid, &qid); };
+	if (!wake()) {
+		waiter_t waiter;
+		m_groups[gid].parked.push_back(&waiter);
+		park(lock, waiter, wake);
+		unpark(m_groups[gid].parked, &waiter);
+		if (m_active) { pass_on(waiter, qid); }
+	}
+	if (!m_active) { return std::nullopt; }
+	return take(qid);
+}
+
+template <typename T, typename Policy>
+template <typename F>
+bool async_queue<T, Policy>::peek(queue_id qid, F&& visitor) {
+	std::scoped_lock lock(m_mutex);
+	queue_id front{};
+	if (!check(qid, &front)) { return false; }
+	visitor(std::as_const(queue(qid).front()));
+	return true;
+}
+
+template <typename T, typename Policy>
+std::vector<T> async_queue<T, Policy>::snapshot(queue_id qid, std::size_t n) const {
+	std::vector<T> ret;
+	std::scoped_lock lock(m_mutex);
+	queue_t const& qu = queue(qid);
+	info_t const& info = m_infos[qid];
+	n = std::min(n, qu.size());
+	if (n == 0) { return ret; }
+	ret.reserve(n);
+	auto const now = clock::now();
+	if (info.deadline) {
+		// heap storage is not in pop order: walk it best-first, copying only the n earliest live items
+		// (expired items have the earliest deadlines, so they are visited first and skipped)
+		auto const later = [&info, &qu](std::size_t a, std::size_t b) { return info.deadline(qu[a]) > info.deadline(qu[b]); };
+		std::vector<std::size_t> frontier{0};
+		while (!frontier.empty() && ret.size() < n) {
+			std::pop_heap(frontier.begin(), frontier.end(), later);
+			std::size_t const index = frontier.back();
+			frontier.pop_back();
+			if (!(info.deadline(qu[index]) < now)) { ret.push_back(qu[index]); }
+			for (std::size_t child = 2 * index + 1; child <= 2 * index + 2 && child < qu.size(); ++child) {
+				frontier.push_back(child);
+				std::push_heap(frontier.begin(), frontier.end(), later);
+			}
+		}
+		return ret;
+	}
+	for (std::size_t i = 0; i < qu.size() && ret.size() < n; ++i) {
+		if (info.ttl && info.expiry[i] < now) { continue; }
+		if (info.tracked && !info.handles.empty()) {
+			if (auto it = info.handles.find(info.seqs[i]); it != info.handles.end() && it->second) { continue; }
+		}
+		ret.push_back(qu[i]);
+	}
+	return ret;
+}
+
+template <typename T, typename Policy>
+std::size_t async_queue<T, Policy>::size(queue_id qid) const {
+	std::scoped_lock lock(m_mutex);
+	return queue(qid).size();
+}
+
+template <typename T, typename Policy>
+typename async_queue<T, Policy>::queue_id async_queue<T, Policy>::add_queue(std::size_t capacity) {
+	// std::deque et al cannot hold storage across drains: requesting capacity from them is an error, not a no-op
+	assert(capacity == 0 || reservable);
+	queue_t qu;
+	if constexpr (reservable) {
+		// allocate and pre-fault outside the lock
+		if (capacity > 0) { qu.reserve(capacity); }
+	} else {
+		capacity = 0;
+	}
+	std::scoped_lock lock(m_mutex);
+	m_queues.push_back(std::move(qu));
+	m_infos.emplace_back().capacity = capacity;
+	if (m_arrival_order) { build_tree(); }
 	return m_queues.size() - 1;
 }
 
+template <typename T, typename Policy>
+typename async_queue<T, Policy>::group_id async_queue<T, Policy>::add_group(std::string name, group_policy policy, std::optional<group_id> parent) {
+	std::scoped_lock lock(m_mutex);
+	group_id const ret = m_groups.size();
+	group_t group;
+	group.name = std::move(name);
+	group.parent = parent;
+	group.policy = policy;
+	m_groups.push_back(std::move(group));
+	if (parent) {
+		assert(*parent < ret);
+		m_groups[*parent].children.push_back({ret, true});
+	}
+	return ret;
+}
+
+template <typename T, typename Policy>
+void async_queue<T, Policy>::order_by_deadline(queue_id qid, deadline_fn deadline, expired_fn on_expired) {
+	std::scoped_lock lock(m_mutex);
+	assert(qid < m_queues.size() && deadline);
+	info_t& info = m_infos[qid];
+	assert(!info.ttl && info.handles.empty() && !m_arrival_order);
+	info.on_expired = std::move(on_expired);
+	if (info.deadline) {
+		info.deadline = std::move(deadline);
+		heapify(qid);
+		return;
+	}
+	info.deadline = std::move(deadline);
+	// barriers need the seqs of items leaving out of push order
+	std::size_t const size = queue(qid).size();
+	if (info.tracked) {
+		// numbered by remove_if(): items missing from the sequence have already left
+		info.low = size > 0 ? info.seqs.front() : info.stats.pushed;
+		for (std::uint64_t seq = info.low, i = 0; seq < info.stats.pushed; ++seq) {
+			if (i < size && info.seqs[i] == seq) {
+				++i;
+			} else {
+				depart(info, seq);
+			}
+		}
+		info.tracked = false;
+	} else {
+		info.low = info.stats.pushed - size;
+		for (std::size_t i = 0; i < size; ++i) { info.seqs.push_back(info.low + i); }
+	}
+	heapify(qid);
+}
+
+template <typename T, typename Policy>
+void async_queue<T, Policy>::expire_after(queue_id qid, clock::duration ttl, expired_fn on_expired) {
+	std::scoped_lock lock(m_mutex);
+	assert(qid < m_queues.size());
+	info_t& info = m_infos[qid];
+	assert(!info.deadline);
+	if (!info.ttl) {
+		// items already queued expire ttl from now
+		info.expiry.assign(queue(qid).size(), clock::now() + ttl);
+		m_ttl_qids.push_back(qid);
+	}
+	info.ttl = ttl;
+	info.on_expired = std::move(on_expired);
+}
+
+template <typename T, typename Policy>
+void async_queue<T, Policy>::order_by_arrival() {
+	std::scoped_lock lock(m_mutex);
+	if (m_arrival_order) { return; }
+	for (queue_id qid = 0; qid < m_queues.size(); ++qid) {
+		info_t& info = m_infos[qid];
+		assert(!info.deadline);
+		// items already queued arrive in qid order
+		for (std::size_t i = 0; i < queue(qid).size(); ++i) { info.arrivals.push_back(m_arrivals++); }
+	}
+	m_arrival_order = true;
+	build_tree();
+}
+
+template <typename T, typename Policy>
+typename async_queue<T, Policy>::queue_set async_queue<T, Policy>::make_set(std::vector<queue_id> qids) {
+	std::scoped_lock lock(m_mutex);
+	assert(!qids.empty());
+	queue_set const ret{m_sets.size()};
+	set_t& set = m_sets.emplace_back();
+	set.qids = std::move(qids);
+	for (std::size_t pos = 0; pos < set.qids.size(); ++pos) {
+		assert(set.qids[pos] < m_queues.size());
+		m_infos[set.qids[pos]].sets.emplace_back(ret.index, pos);
+	}
+	if (m_arrival_order) { build_set(set); }
+	return ret;
+}
+
+template <typename T, typename Policy>
+void async_queue<T, Policy>::byte_limits(size_fn size, std::size_t limit, overflow_policy overflow) {
+	{
+		std::scoped_lock lock(m_mutex);
+		assert(size);
+		m_size = std::move(size);
+		m_bytes.limit = limit;
+		m_overflow = overflow;
+		m_bytes.used = 0;
+		for (queue_id qid = 0; qid < m_queues.size(); ++qid) {
+			m_infos[qid].bytes.used = 0;
+			for (T const& t : queue(qid)) { charge(qid, m_size(t)); }
+		}
+	}
+	m_drained_cv.notify_all();
+}
+
+template <typename T, typename Policy>
+void async_queue<T, Policy>::byte_limit(queue_id qid, std::size_t limit) {
+	{
+		std::scoped_lock lock(m_mutex);
+		assert(m_size);
+		m_infos[qid].bytes.limit = limit;
+	}
+	m_drained_cv.notify_all();
+}
+
+template <typename T, typename Policy>
+void async_queue<T, Policy>::on_ready(ready_fn ready) {
+	std::scoped_lock lock(m_mutex);
+	m_ready = std::move(ready);
+}
+
+template <typename T, typename Policy>
+void async_queue<T, Policy>::wake_order(wake_policy policy) {
+	std::scoped_lock lock(m_mutex);
+	m_wake = policy;
+}
+
+template <typename T, typename Policy>
+typename async_queue<T, Policy>::byte_usage async_queue<T, Policy>::bytes(queue_id qid) const {
+	std::scoped_lock lock(m_mutex);
+	return m_infos[qid].bytes;
+}
+
+template <typename T, typename Policy>
+typename async_queue<T, Policy>::byte_usage async_queue<T, Policy>::bytes() const {
+	std::scoped_lock lock(m_mutex);
+	return m_bytes;
+}
+
+template <typename T, typename Policy>
+void async_queue<T, Policy>::sweep() {
+	std::scoped_lock lock(m_mutex);
+	for (queue_id qid : m_ttl_qids) {
+		shed(qid);
+		if (queue(qid).empty() && m_infos[qid].capacity == 0) {
+			queue(qid).shrink_to_fit();
+			m_infos[qid].expiry.shrink_to_fit();
+		}
+	}
+}
+
+template <typename T, typename Policy>
+typename async_queue<T, Policy>::queue_stats async_queue<T, Policy>::stats(queue_id qid) const {
+	std::scoped_lock lock(m_mutex);
+	return m_infos[qid].stats;
+}
+
+template <typename T, typename Policy>
+void async_queue<T, Policy>::attach(queue_id qid, group_id gid) {
+	std::scoped_lock lock(m_mutex);
+	assert(qid < m_queues.size() && gid < m_groups.size());
+	bool const populated = !queue(qid).empty();
+	info_t& info = m_infos[qid];
+	if (info.group) {
+		auto& children = m_groups[*info.group].children;
+		for (auto it = children.begin(); it != children.end(); ++it) {
+			if (!it->group && it->index == qid) {
+				children.erase(it);
+				break;
+			}
+		}
+		if (populated) { mark(info.group, false); }
+	}
+	info.group = gid;
+	m_groups[gid].children.push_back({qid, false});
+	if (populated) {
+		mark(gid, true);
+		// queued items are now visible to the new group's waiters
+		wake(qid, queue(qid).size());
+	}
+}
+
+template <typename T, typename Policy>
+std::optional<typename async_queue<T, Policy>::group_id> async_queue<T, Policy>::find_group(std::string_view name) const {
+	std::scoped_lock lock(m_mutex);
+	for (std::size_t i = 0; i < m_groups.size(); ++i) {
+		if (m_groups[i].name == name) { return i; }
+	}
+	return std::nullopt;
+}
+
 template <typename T, typename Policy>
 typename async_queue<T, Policy>::queue_t async_queue<T, Policy>::clear(bool active) {
 	queue_t ret;
 	{
 		std::scoped_lock lock(m_mutex);
 		m_active = active;
-		for (queue_t& queue : m_queues) {
-			std::move(std::begin(queue), std::end(queue), std::back_inserter(ret));
-			queue.clear();
+		for (queue_id qid = 0; qid < m_queues.size(); ++qid) {
+			queue_t& qu = queue(qid);
+			m_infos[qid].stats.removed += qu.size();
+			m_infos[qid].expiry.clear();
+			m_infos[qid].seqs.clear();
+			m_infos[qid].departed.clear();
+			m_infos[qid].low = m_infos[qid].stats.pushed;
+			m_infos[qid].handles.clear();
+			m_infos[qid].arrivals.clear();
+			m_infos[qid].bytes.used = 0;
+			std::move(std::begin(qu), std::end(qu), std::back_inserter(ret));
+			qu.clear();
 		}
+		for (group_t& group : m_groups) { group.populated = 0; }
+		if (m_arrival_order) { build_tree(); }
+		m_bytes.used = 0;
+		wake_all();
 	}
-	m_cv.notify_all();
+	m_drained_cv.notify_all();
 	return ret;
 }
 
@@ -213,6 +1174,79 @@ bool async_queue<T, Policy>::empty() const {
 	return true;
 }
 
+template <typename T, typename Policy>
+bool async_queue<T, Policy>::wait_empty(queue_id qid) {
+	return wait_drained([this, qid]() { return queue(qid).empty(); });
+}
+
+template <typename T, typename Policy>
+bool async_queue<T, Policy>::wait_empty() {
+	return wait_drained([this]() {
+		for (queue_t const& qu : m_queues) {
+			if (!qu.empty()) { return false; }
+		}
+		return true;
+	});
+}
+
+template <typename T, typename Policy>
+typename async_queue<T, Policy>::flush_barrier async_queue<T, Policy>::barrier(queue_id qid) const {
+	flush_barrier ret;
+	std::scoped_lock lock(m_mutex);
+	ret.marks.resize(qid + 1);
+	ret.marks[qid] = m_infos[qid].stats.pushed;
+	return ret;
+}
+
+template <typename T, typename Policy>
+typename async_queue<T, Policy>::flush_barrier async_queue<T, Policy>::barrier() const {
+	flush_barrier ret;
+	std::scoped_lock lock(m_mutex);
+	ret.marks.reserve(m_infos.size());
+	for (info_t const& info : m_infos) { ret.marks.push_back(info.stats.pushed); }
+	return ret;
+}
+
+template <typename T, typename Policy>
+bool async_queue<T, Policy>::wait(flush_barrier const& fb) {
+	return wait_drained([this, &fb]() {
+		for (std::size_t qid = 0; qid < fb.marks.size(); ++qid) {
+			if (!passed(qid, fb.marks[qid])) { return false; }
+		}
+		return true;
+	});
+}
+
+template <typename T, typename Policy>
+void async_queue<T, Policy>::done(std::size_t count) noexcept {
+	m_in_flight[shard_index()].count.fetch_sub(static_cast<std::int64_t>(count));
+	if (m_quiescent_waiters.load() > 0) {
+		// lock to serialize with a waiter between evaluating its predicate and sleeping
+		{ std::scoped_lock lock(m_mutex); }
+		m_drained_cv.notify_all();
+	}
+}
+
+template <typename T, typename Policy>
+std::int64_t async_queue<T, Policy>::in_flight() const noexcept {
+	std::int64_t ret{};
+	for (shard_t const& shard : m_in_flight) { ret += shard.count.load(); }
+	return ret;
+}
+
+template <typename T, typename Policy>
+bool async_queue<T, Policy>::wait_quiescent() {
+	++m_quiescent_waiters;
+	bool const ret = wait_drained([this]() {
+		for (queue_t const& qu : m_queues) {
+			if (!qu.empty()) { return false; }
+		}
+		return in_flight() == 0;
+	});
+	--m_quiescent_waiters;
+	return ret;
+}
+
 template <typename T, typename Policy>
 bool async_queue<T, Policy>::active() const {
 	std::scoped_lock lock(m_mutex);
@@ -224,7 +1258,456 @@ void async_queue<T, Policy>::active(bool set) {
 	{
 		std::scoped_lock lock(m_mutex);
 		m_active = set;
+		wake_all();
 	}
-	m_cv.notify_all();
+	m_drained_cv.notify_all();
+}
+
+template <typename T, typename Policy>
+template <typename Pred>
+bool async_queue<T, Policy>::wait_drained(Pred pred) {
+	std::unique_lock lock(m_mutex);
+	++m_drain_waiters;
+	m_drained_cv.wait(lock, [this, &pred]() { return !m_active || pred(); });
+	--m_drain_waiters;
+	return pred();
+}
+
+template <typename T, typename Policy>
+template <typename Pred>
+void async_queue<T, Policy>::park(std::unique_lock<mutex_t>& lock, waiter_t& waiter, Pred wake) {
+	// a signalled waiter that finds nothing (item taken by a non-waiting pop / shed) parks again
+	while (!wake()) {
+		waiter.signalled = false;
+		waiter.cause.reset();
+		waiter.parked_at = m_parks++;
+		waiter.cv.wait(lock, [&waiter]() { return waiter.signalled; });
+	}
+}
+
+template <typename T, typename Policy>
+void async_queue<T, Policy>::wake(queue_id qid, std::size_t count) {
+	// hand each item to a distinct parked waiter: k items wake at most k consumers
+	// candidates are waiting on qid or any of its ancestor groups; pick the oldest / newest by park order
+	bool const lifo = m_wake == wake_policy::lifo;
+	for (; count > 0; --count) {
+		waiter_t* next{};
+		auto const scan = [&next, lifo](std::vector<waiter_t*> const& parked) {
+			for (waiter_t* waiter : parked) {
+				if (waiter->signalled) { continue; }
+				if (!next || (lifo ? waiter->parked_at > next->parked_at : waiter->parked_at < next->parked_at)) { next = waiter; }
+			}
+		};
+		scan(m_infos[qid].parked);
+		for (auto gid = m_infos[qid].group; gid; gid = m_groups[*gid].parent) { scan(m_groups[*gid].parked); }
+		if (!next) { return; }
+		next->signalled = true;
+		next->cause = qid;
+		next->cv.notify_one();
+	}
+}
+
+template <typename T, typename Policy>
+void async_queue<T, Policy>::pass_on(waiter_t const& waiter, queue_id taken) {
+	// the waiter was handed an item of cause but takes one from another queue (pushed while it was already signalled,
+	// so that push woke nobody): hand the cause item on, else a consumer parked only on cause sleeps next to it
+	if (waiter.cause && *waiter.cause != taken && !queue(*waiter.cause).empty()) { wake(*waiter.cause, 1); }
+}
+
+template <typename T, typename Policy>
+void async_queue<T, Policy>::wake_all() {
+	auto const signal = [](std::vector<waiter_t*> const& parked) {
+		for (waiter_t* waiter : parked) {
+			waiter->signalled = true;
+			waiter->cv.notify_one();
+		}
+	};
+	for (info_t const& info : m_infos) { signal(info.parked); }
+	for (group_t const& group : m_groups) { signal(group.parked); }
+}
+
+template <typename T, typename Policy>
+std::size_t async_queue<T, Policy>::move_items(async_queue& src, queue_id from, async_queue& dst, queue_id to, std::size_t n) {
+	if (&src == &dst && from == to) { return 0; }
+	std::size_t ret{};
+	{
+		std::unique_lock<mutex_t> src_lock(src.m_mutex, std::defer_lock);
+		std::unique_lock<mutex_t> dst_lock(dst.m_mutex, std::defer_lock);
+		if (&src == &dst) {
+			src_lock.lock();
+		} else {
+			std::lock(src_lock, dst_lock);
+		}
+		if (!dst.m_active) { return 0; }
+		queue_t& source = src.queue(from);
+		queue_t& target = dst.queue(to);
+		info_t& src_info = src.m_infos[from];
+		if (src_info.ttl || src_info.deadline) { src.shed(from); }
+		if (source.empty() || n == 0) { return 0; }
+		if (n >= source.size() && target.empty() && plain(src_info) && plain(dst.m_infos[to]) && src_info.capacity == 0 && dst.m_infos[to].capacity == 0) {
+			// whole queue into an empty one: exchange storage (reserved storage stays with its queue)
+			using std::swap;
+			swap(source, target);
+			ret = target.size();
+			src.mark(src_info.group, false);
+			if (&src == &dst) {
+				dst.m_infos[to].bytes.used = std::exchange(src_info.bytes.used, 0);
+			} else {
+				src.release(from, src_info.bytes.used);
+				if (dst.m_size) {
+					for (T const& t : target) { dst.charge(to, dst.m_size(t)); }
+				}
+			}
+			if (src.m_arrival_order) {
+				src_info.arrivals.clear();
+				src.update_head(from);
+			}
+		} else {
+			for (; ret < n && !source.empty(); ++ret) {
+				T t = src.pop_front(from);
+				if (dst.m_size) { dst.charge(to, dst.m_size(t)); }
+				target.push_back(std::move(t));
+				src.skip(from);
+			}
+		}
+		src_info.stats.removed += ret;
+		dst.on_push(to, ret);
+	}
+	src.m_drained_cv.notify_all();
+	return ret;
+}
+
+template <typename T, typename Policy>
+std::size_t async_queue<T, Policy>::shard_index() noexcept {
+	static std::atomic<std::size_t> s_next{};
+	thread_local std::size_t const t_index = s_next++ % std::tuple_size_v<decltype(m_in_flight)>;
+	return t_index;
+}
+
+template <typename T, typename Policy>
+bool async_queue<T, Policy>::select(group_id gid, queue_id* out) {
+	group_t& group = m_groups[gid];
+	if (group.populated == 0) { return false; }
+	std::size_t const count = group.children.size();
+	std::size_t const start = group.policy == group_policy::round_robin ? group.cursor : 0;
+	for (std::size_t i = 0; i < count; ++i) {
+		std::size_t const index = (start + i) % count;
+		child_t const& child = group.children[index];
+		if (child.group ? select(child.index, out) : check(child.index, out)) {
+			group.cursor = (index + 1) % count;
+			return true;
+		}
+	}
+	return false;
+}
+
+template <typename T, typename Policy>
+void async_queue<T, Policy>::mark(std::optional<group_id> gid, bool populated) noexcept {
+	// propagate empty <-> populated transitions up the group chain, stopping at the first group whose state is unchanged
+	while (gid) {
+		group_t& group = m_groups[*gid];
+		if (populated) {
+			if (group.populated++ > 0) { return; }
+		} else {
+			assert(group.populated > 0);
+			if (--group.populated > 0) { return; }
+		}
+		gid = group.parent;
+	}
+}
+
+template <typename T, typename Policy>
+void async_queue<T, Policy>::on_push(queue_id qid, std::size_t count) {
+	info_t& info = m_infos[qid];
+	if (info.tracked || info.deadline) {
+		for (std::size_t i = 0; i < count; ++i) { info.seqs.push_back(info.stats.pushed + i); }
+	}
+	info.stats.pushed += count;
+	queue_t& qu = queue(qid);
+	// the amortized TTL sweep below may shed items from this queue too: decide before it runs
+	bool const was_empty = count > 0 && qu.size() == count;
+	if (was_empty) { mark(info.group, true); }
+	if (m_arrival_order) {
+		for (std::size_t i = 0; i < count; ++i) { info.arrivals.push_back(m_arrivals++); }
+		if (was_empty) { update_head(qid); }
+	}
+	if (info.deadline) {
+		for (std::size_t i = qu.size() - count; i < qu.size(); ++i) { sift_up(qid, i); }
+	}
+	if (info.ttl) {
+		info.expiry.insert(info.expiry.end(), count, clock::now() + *info.ttl);
+		// amortized sweep: each push to a TTL queue also sheds the next TTL queue in turn (reclaims idle ones)
+		shed(m_ttl_qids[m_sweep++ % m_ttl_qids.size()]);
+	}
+	if (count > 0 && m_ready) { m_ready(qid, count); }
+	if (count > 0) { wake(qid, count); }
+}
+
+template <typename T, typename Policy>
+void async_queue<T, Policy>::shed(queue_id qid) {
+	info_t& info = m_infos[qid];
+	queue_t& qu = queue(qid);
+	if (qu.empty()) { return; }
+	auto const now = clock::now();
+	bool any = false;
+	for (;;) {
+		// cancelled items are discarded (counted as removed), never handed to on_expired
+		skip(qid);
+		if (qu.empty() || !expired(qid, now)) { break; }
+		T t = pop_front(qid);
+		++info.stats.expired;
+		any = true;
+		if (info.on_expired) { info.on_expired(std::move(t)); }
+	}
+	if (any && m_drain_waiters > 0) { m_drained_cv.notify_all(); }
+}
+
+template <typename T, typename Policy>
+void async_queue<T, Policy>::skip(queue_id qid) {
+	// maintains the invariant that the front of a tracked queue is never a cancelled item
+	info_t& info = m_infos[qid];
+	if (!info.tracked || info.handles.empty()) { return; }
+	queue_t& qu = queue(qid);
+	while (!qu.empty()) {
+		auto it = info.handles.find(info.seqs.front());
+		if (it == info.handles.end() || !it->second) { return; }
+		pop_front(qid);
+		++info.stats.removed;
+	}
+}
+
+template <typename T, typename Policy>
+T async_queue<T, Policy>::pop_front(queue_id qid) {
+	queue_t& qu = queue(qid);
+	info_t& info = m_infos[qid];
+	assert(!qu.empty());
+	if (m_size) { release(qid, m_size(qu.front())); }
+	if (info.deadline) {
+		// heap top is at the front: replace it with the last item and restore the heap
+		T ret = std::move(qu.front());
+		depart(info, info.seqs.front());
+		if (qu.size() > 1) {
+			qu.front() = std::move(qu.back());
+			info.seqs.front() = info.seqs.back();
+		}
+		qu.pop_back();
+		info.seqs.pop_back();
+		if (qu.empty()) {
+			mark(info.group, false);
+		} else {
+			sift_down(qid, 0);
+		}
+		return ret;
+	}
+	T ret = std::move(qu.front());
+	qu.pop_front();
+	if (info.ttl) { info.expiry.pop_front(); }
+	if (info.tracked) {
+		if (!info.handles.empty()) { info.handles.erase(info.seqs.front()); }
+		info.seqs.pop_front();
+	}
+	if (m_arrival_order) {
+		info.arrivals.pop_front();
+		update_head(qid);
+	}
+	if (qu.empty()) { mark(info.group, false); }
+	return ret;
+}
+
+template <typename T, typename Policy>
+void async_queue<T, Policy>::update_head(queue_id qid) noexcept {
+	auto const& arrivals = m_infos[qid].arrivals;
+	m_heads[qid] = arrivals.empty() ? no_arrival : arrivals.front();
+	for (std::size_t node = (m_heads.size() + qid) / 2; node > 0; node /= 2) {
+		queue_id const left = m_tree[2 * node];
+		queue_id const right = m_tree[2 * node + 1];
+		m_tree[node] = m_heads[right] < m_heads[left] ? right : left;
+	}
+	for (auto const& [index, pos] : m_infos[qid].sets) { update_set(m_sets[index], pos); }
+}
+
+template <typename T, typename Policy>
+void async_queue<T, Policy>::update_set(set_t& set, std::size_t pos) noexcept {
+	for (std::size_t node = (set.tree.size() / 2 + pos) / 2; node > 0; node /= 2) {
+		std::size_t const left = set.tree[2 * node];
+		std::size_t const right = set.tree[2 * node + 1];
+		set.tree[node] = head(set, right) < head(set, left) ? right : left;
+	}
+}
+
+template <typename T, typename Policy>
+void async_queue<T, Policy>::build_set(set_t& set) {
+	std::size_t leaves = 1;
+	while (leaves < set.qids.size()) { leaves *= 2; }
+	set.tree.assign(2 * leaves, 0);
+	for (std::size_t pos = 0; pos < leaves; ++pos) { set.tree[leaves + pos] = pos; }
+	for (std::size_t node = leaves - 1; node > 0; --node) {
+		std::size_t const left = set.tree[2 * node];
+		std::size_t const right = set.tree[2 * node + 1];
+		set.tree[node] = head(set, right) < head(set, left) ? right : left;
+	}
+}
+
+template <typename T, typename Policy>
+void async_queue<T, Policy>::build_tree() {
+	std::size_t leaves = 1;
+	while (leaves < m_queues.size()) { leaves *= 2; }
+	m_heads.assign(leaves, no_arrival);
+	m_tree.assign(2 * leaves, 0);
+	for (queue_id qid = 0; qid < leaves; ++qid) {
+		m_tree[leaves + qid] = qid;
+		if (qid < m_queues.size() && !m_infos[qid].arrivals.empty()) { m_heads[qid] = m_infos[qid].arrivals.front(); }
+	}
+	for (std::size_t node = leaves - 1; node > 0; --node) {
+		queue_id const left = m_tree[2 * node];
+		queue_id const right = m_tree[2 * node + 1];
+		m_tree[node] = m_heads[right] < m_heads[left] ? right : left;
+	}
+	for (set_t& set : m_sets) { build_set(set); }
+}
+
+template <typename T, typename Policy>
+bool async_queue<T, Policy>::fits(queue_id qid, std::size_t size) const noexcept {
+	byte_usage const& local = m_infos[qid].bytes;
+	bool const local_fits = local.limit == 0 || local.used == 0 || local.used + size <= local.limit;
+	bool const global_fits = m_bytes.limit == 0 || m_bytes.used == 0 || m_bytes.used + size <= m_bytes.limit;
+	return local_fits && global_fits;
+}
+
+template <typename T, typename Policy>
+bool async_queue<T, Policy>::admit(std::unique_lock<mutex_t>& lock, queue_id qid, std::size_t size, bool wait) {
+	if (fits(qid, size)) { return true; }
+	info_t& info = m_infos[qid];
+	switch (m_overflow) {
+	case overflow_policy::drop_oldest: {
+		// dropping only frees this queue's bytes: if the global limit cannot be met even with it empty, keep its items
+		std::size_t const others = m_bytes.used - info.bytes.used;
+		if (m_bytes.limit > 0 && others > 0 && others + size > m_bytes.limit) { break; }
+		while (!fits(qid, size) && !queue(qid).empty()) {
+			pop_front(qid);
+			skip(qid);
+			++info.stats.dropped;
+		}
+		if (fits(qid, size)) { return true; }
+		break;
+	}
+	case overflow_policy::block: {
+		if (!wait) { break; }
+		info.bytes.reserved += size;
+		m_bytes.reserved += size;
+		++m_drain_waiters;
+		m_drained_cv.wait(lock, [this, qid, size]() { return !m_active || fits(qid, size); });
+		--m_drain_waiters;
+		info.bytes.reserved -= size;
+		m_bytes.reserved -= size;
+		if (m_active) { return true; }
+		return false;
+	}
+	default: break;
+	}
+	++info.stats.rejected;
+	return false;
+}
+
+template <typename T, typename Policy>
+void async_queue<T, Policy>::charge(queue_id qid, std::size_t size) noexcept {
+	m_infos[qid].bytes.used += size;
+	m_bytes.used += size;
+}
+
+template <typename T, typename Policy>
+void async_queue<T, Policy>::release(queue_id qid, std::size_t size) noexcept {
+	m_infos[qid].bytes.used -= size;
+	m_bytes.used -= size;
+}
+
+template <typename T, typename Policy>
+bool async_queue<T, Policy>::expired(queue_id qid, clock::time_point now) const {
+	info_t const& info = m_infos[qid];
+	if (info.deadline) { return info.deadline(queue(qid).front()) < now; }
+	return info.expiry.front() < now;
+}
+
+template <typename T, typename Policy>
+T async_queue<T, Policy>::take(queue_id qid) {
+	T ret = pop_front(qid);
+	skip(qid);
+	++m_infos[qid].stats.popped;
+	m_in_flight[shard_index()].count.fetch_add(1, std::memory_order_relaxed);
+	// producers waiting on drain conditions are only woken by pops (never by pushes)
+	if (m_drain_waiters > 0) { m_drained_cv.notify_all(); }
+	return ret;
+}
+
+template <typename T, typename Policy>
+bool async_queue<T, Policy>::passed(queue_id qid, std::uint64_t mark) const noexcept {
+	// a mark is passed once no item pushed before it remains: compare against the oldest queued item's seq
+	queue_t const& qu = queue(qid);
+	if (qu.empty()) { return true; }
+	info_t const& info = m_infos[qid];
+	// deadline ordered queues pop out of push order: track the lowest seq yet to leave
+	if (info.deadline) { return info.low >= mark; }
+	// untracked FIFO queues only lose items from the front, so theirs are the last size() seqs pushed
+	std::uint64_t const oldest = info.tracked ? info.seqs.front() : info.stats.pushed - qu.size();
+	return oldest >= mark;
+}
+template <typename T, typename Policy>
+void async_queue<T, Policy>::depart(info_t& info, std::uint64_t seq) {
+	auto& words = info.departed;
+	auto const word = static_cast<std::size_t>(seq / 64 - info.low / 64);
+	if (word >= words.size()) { words.resize(word + 1); }
+	words[word] |= std::uint64_t{1} << (seq % 64);
+	// advance low past contiguous departed seqs, dropping words once passed
+	while (!words.empty() && ((words.front() >> (info.low % 64)) & 1) != 0) {
+		if (++info.low % 64 == 0) { words.pop_front(); }
+	}
+}
+
+template <typename T, typename Policy>
+void async_queue<T, Policy>::sift_up(queue_id qid, std::size_t index) {
+	// min-heap on deadline, moving seqs along with items (std heap algorithms cannot permute a parallel container)
+	queue_t& qu = queue(qid);
+	info_t& info = m_infos[qid];
+	T t = std::move(qu[index]);
+	std::uint64_t const seq = info.seqs[index];
+	auto const deadline = info.deadline(t);
+	while (index > 0) {
+		std::size_t const parent = (index - 1) / 2;
+		if (!(deadline < info.deadline(qu[parent]))) { break; }
+		qu[index] = std::move(qu[parent]);
+		info.seqs[index] = info.seqs[parent];
+		index = parent;
+	}
+	qu[index] = std::move(t);
+	info.seqs[index] = seq;
+}
+
+template <typename T, typename Policy>
+void async_queue<T, Policy>::sift_down(queue_id qid, std::size_t index) {
+	queue_t& qu = queue(qid);
+	info_t& info = m_infos[qid];
+	T t = std::move(qu[index]);
+	std::uint64_t const seq = info.seqs[index];
+	auto const deadline = info.deadline(t);
+	for (std::size_t child = 2 * index + 1; child < qu.size(); child = 2 * index + 1) {
+		auto earliest = info.deadline(qu[child]);
+		if (child + 1 < qu.size()) {
+			if (auto const right = info.deadline(qu[child + 1]); right < earliest) {
+				++child;
+				earliest = right;
+			}
+		}
+		if (!(earliest < deadline)) { break; }
+		qu[index] = std::move(qu[child]);
+		info.seqs[index] = info.seqs[child];
+		index = child;
+	}
+	qu[index] = std::move(t);
+	info.seqs[index] = seq;
+}
+
+template <typename T, typename Policy>
+void async_queue<T, Policy>::heapify(queue_id qid) {
+	for (std::size_t i = queue(qid).size() / 2; i > 0; --i) { sift_down(qid, i - 1); }
 }
 } // namespace kt
@@ -0,0 +1,168 @@
+// KT header-only library
+// Requirements: C++17
+//
+// Features:
+// 	- Bump allocation of item payloads for a producer batch (one allocation per block, not per item)
+// 	- Blocks are reference counted per block, not per item, and freed as a unit when their last item is released
+// 	- Move-only item handles (arena_ptr<T>) to push through async_queue
+//
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace kt {
+namespace detail {
+///
+/// \brief Arena block header (payload bytes follow in the same allocation)
+///
+struct arena_block {
+	std::atomic<std::uint32_t> refs{1}; // one reference held by the owning batch_arena
+	std::size_t capacity{};
+	std::size_t used{};
+
+	static arena_block* make(std::size_t capacity) {
+		void* const buffer = ::operator new(sizeof(arena_block) + capacity);
+		auto* ret = new (buffer) arena_block;
+		ret->capacity = capacity;
+		return ret;
+	}
+
+	std::byte* data() noexcept { return reinterpret_cast<std::byte*>(this + 1); }
+
+	void* allocate(std::size_t size, std::size_t align) noexcept {
+		auto const base = reinterpret_cast<std::uintptr_t>(data());
+		std::size_t const offset = ((base + used + align - 1) & ~(align - 1)) - base;
+		if (offset + size > capacity) { return nullptr; }
+		used = offset + size;
+		return data() + offset;
+	}
+
+	void retain() noexcept { refs.fetch_add(1, std::memory_order_relaxed); }
+
+	void release() noexcept {
+		if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			this->~arena_block();
+			::operator delete(this);
+		}
+	}
+};
+} // namespace detail
+
+///
+/// \brief Move-only owning handle to a T allocated in a batch_arena block
+///
+/// Destroying (or reset()ing) the handle destroys the T and releases its block reference.
+///
+template <typename T>
+class arena_ptr {
+  public:
+	using element_type = T;
+
+	arena_ptr() = default;
+	arena_ptr(arena_ptr&& rhs) noexcept : m_ptr(std::exchange(rhs.m_ptr, nullptr)), m_block(std::exchange(rhs.m_block, nullptr)) {}
+	arena_ptr& operator=(arena_ptr&& rhs) noexcept {
+		if (&rhs != this) {
+			reset();
+			m_ptr = std::exchange(rhs.m_ptr, nullptr);
+			m_block = std::exchange(rhs.m_block, nullptr);
+		}
+		return *this;
+	}
+	~arena_ptr() noexcept { reset(); }
+
+	void reset() noexcept {
+		if (!m_ptr) { return; }
+		m_ptr->~T();
+		m_block->release();
+		m_ptr = nullptr;
+		m_block = nullptr;
+	}
+
+	T* get() const noexcept { return m_ptr; }
+	T& operator*() const noexcept { return *m_ptr; }
+	T* operator->() const noexcept { return m_ptr; }
+	explicit operator bool() const noexcept { return m_ptr != nullptr; }
+
+  private:
+	arena_ptr(T* ptr, detail::arena_block* block) noexcept : m_ptr(ptr), m_block(block) {}
+
+	T* m_ptr{};
+	detail::arena_block* m_block{};
+
+	friend class batch_arena;
+};
+
+///
+/// \brief Producer-side bump allocator for a batch of items
+///
+/// Not thread safe: intended to be owned by one producer (handles it creates may be released on any thread).
+/// A new block is started when the current one is full, or explicitly via next_batch().
+///
+class batch_arena {
+  public:
+	static constexpr std::size_t default_block_size = 64 * 1024;
+
+	explicit batch_arena(std::size_t block_size = default_block_size) noexcept : m_block_size(block_size) {}
+	~batch_arena() noexcept { next_batch(); }
+
+	batch_arena(batch_arena&& rhs) noexcept : m_block(std::exchange(rhs.m_block, nullptr)), m_block_size(rhs.m_block_size) {}
+	batch_arena& operator=(batch_arena&& rhs) noexcept {
+		if (&rhs != this) {
+			next_batch();
+			m_block = std::exchange(rhs.m_block, nullptr);
+			m_block_size = rhs.m_block_size;
+		}
+		return *this;
+	}
+
+	///
+	/// \brief Construct a T in the current block and obtain its handle
+	///
+	template <typename T, typename... Args>
+	arena_ptr<T> make(Args&&... args);
+	///
+	/// \brief Stop allocating from the current block (it is freed once its items are released)
+	///
+	void next_batch() noexcept {
+		if (m_block) { std::exchange(m_block, nullptr)->release(); }
+	}
+
+	std::size_t block_size() const noexcept { return m_block_size; }
+
+  private:
+	void* allocate(std::size_t size, std::size_t align);
+
+	detail::arena_block* m_block{};
+	std::size_t m_block_size;
+};
+
+template <typename T, typename... Args>
+arena_ptr<T> batch_arena::make(Args&&... args) {
+	static_assert(!std::is_array_v<T>, "Arrays not supported");
+	void* const buffer = allocate(sizeof(T), alignof(T));
+	// reference is taken only once construction has succeeded
+	T* const ptr = new (buffer) T(std::forward<Args>(args)...);
+	m_block->retain();
+	return arena_ptr<T>(ptr, m_block);
+}
+
+inline void* batch_arena::allocate(std::size_t size, std::size_t align) {
+	if (m_block) {
+		if (void* ret = m_block->allocate(size, align)) { return ret; }
+	}
+	// oversized items get a block of their own (still released as a unit)
+	auto* block = detail::arena_block::make(std::max(m_block_size, size + align));
+	next_batch();
+	m_block = block;
+	void* const ret = m_block->allocate(size, align);
+	assert(ret);
+	return ret;
+}
+} // namespace kt
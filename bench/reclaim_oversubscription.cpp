@@ -0,0 +1,128 @@
+// Benchmark: reclamation overhead of reclaim.hpp policies on a Treiber stack, with up to 8x more threads than cores.
+// Each thread pushes a node and pops one (retiring it) per op. Reported per policy and thread count:
+// 	- ns/op: wall time per push + pop pair (all threads)
+// 	- overhead: relative to a baseline that never frees during the run (retired nodes are kept until the end)
+// 	- peak garbage: most retired-but-not-yet-freed nodes seen by a 1ms sampler (preempted readers hold up epochs)
+//
+// Build: g++ -std=c++17 -O2 -pthread bench/reclaim_oversubscription.cpp && ./a.out [ops per thread]
+
+#include "../reclaim.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+std::atomic<long> g_garbage{}; // retired, not yet freed
+
+struct node_t {
+	long value{};
+	node_t* next{};
+};
+
+void free_node(void* ptr) {
+	delete static_cast<node_t*>(ptr);
+	g_garbage.fetch_sub(1, std::memory_order_relaxed);
+}
+
+// baseline: guard shaped like the reclaimers' but retired nodes are only freed when the domain is destroyed
+struct no_reclaim {
+	struct guard {
+		node_t* protect(std::atomic<node_t*> const& src) const noexcept { return src.load(std::memory_order_acquire); }
+		void retire(kt::retired_node node) { retired->push_back(node); }
+		std::vector<kt::retired_node>* retired;
+	};
+
+	~no_reclaim() {
+		for (auto& list : m_retired) {
+			for (kt::retired_node const& node : list) { node.deleter(node.ptr); }
+		}
+	}
+
+	guard pin() {
+		// one list per thread (registered on its first pin of this domain): workers never share a vector
+		thread_local no_reclaim const* owner{};
+		thread_local std::vector<kt::retired_node>* list{};
+		if (owner != this) {
+			std::scoped_lock lock(m_mutex);
+			list = &m_retired.emplace_back();
+			owner = this;
+		}
+		return {list};
+	}
+
+	std::deque<std::vector<kt::retired_node>> m_retired; // stable addresses as threads register
+	std::mutex m_mutex;
+};
+
+struct result_t {
+	double ns_per_op{};
+	long peak_garbage{};
+};
+
+template <typename Reclaimer>
+result_t run(unsigned threads, long ops) {
+	result_t ret;
+	Reclaimer reclaimer;
+	std::atomic<node_t*> head{};
+	std::atomic<bool> go{};
+	std::atomic<bool> done{};
+	std::vector<std::thread> workers;
+	for (unsigned t = 0; t < threads; ++t) {
+		workers.emplace_back([&]() {
+			while (!go.load()) { std::this_thread::yield(); }
+			for (long i = 0; i < ops; ++i) {
+				auto* n = new node_t{i};
+				n->next = head.load(std::memory_order_relaxed);
+				while (!head.compare_exchange_weak(n->next, n, std::memory_order_release, std::memory_order_relaxed)) {}
+				auto guard = reclaimer.pin();
+				node_t* top = guard.protect(head);
+				while (top && !head.compare_exchange_weak(top, top->next, std::memory_order_acquire)) { top = guard.protect(head); }
+				if (!top) { continue; }
+				g_garbage.fetch_add(1, std::memory_order_relaxed);
+				guard.retire(kt::retired_node{top, &free_node});
+			}
+		});
+	}
+	std::thread sampler([&]() {
+		while (!done.load()) {
+			ret.peak_garbage = std::max(ret.peak_garbage, g_garbage.load(std::memory_order_relaxed));
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	});
+	auto const start = std::chrono::steady_clock::now();
+	go = true;
+	for (auto& worker : workers) { worker.join(); }
+	auto const elapsed = std::chrono::steady_clock::now() - start;
+	done = true;
+	sampler.join();
+	ret.ns_per_op = double(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / double(ops * threads);
+	while (node_t* top = head.load()) {
+		head = top->next;
+		delete top;
+	}
+	return ret;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+	long const ops = argc > 1 ? std::atol(argv[1]) : 200000;
+	unsigned const cores = std::max(1u, std::thread::hardware_concurrency());
+	std::printf("cores: %u, ops per thread: %ld\n", cores, ops);
+	std::printf("%8s  %-16s %10s %10s %14s\n", "threads", "policy", "ns/op", "overhead", "peak garbage");
+	for (unsigned factor : {1u, 2u, 4u, 8u}) {
+		unsigned const threads = cores * factor;
+		auto const base = run<no_reclaim>(threads, ops);
+		auto const report = [&](char const* name, result_t const& r) {
+			std::printf("%8u  %-16s %10.1f %9.2fx %14ld\n", threads, name, r.ns_per_op, r.ns_per_op / base.ns_per_op, r.peak_garbage);
+		};
+		report("none (baseline)", base);
+		report("epoch_based", run<kt::reclaimer<kt::epoch_based>>(threads, ops));
+		report("hazard_pointers", run<kt::reclaimer<kt::hazard_pointers<1>>>(threads, ops));
+	}
+}
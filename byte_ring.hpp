@@ -0,0 +1,270 @@
+// KT header-only library
+// Requirements: C++17
+//
+// Features:
+// 	- Variable-length byte records in one contiguous ring (no allocation per record)
+// 	- Thread-safe reserve-write-commit (producers write records in place)
+// 	- Thread-safe wait-and-read (consumers process records in place, then release)
+// 	- Records never straddle the wrap point (bip-buffer style padding)
+// 	- Deactivate (as secondary wait condition)
+//
+
+#pragma once
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+namespace kt {
+///
+/// \brief Ring of framed byte records with in-place write and read
+///
+/// At most one reservation and one read are outstanding at a time; other producers / consumers wait their turn.
+/// Writing and reading the payload happen outside the lock.
+///
+class byte_ring {
+  public:
+	///
+	/// \brief Writable bytes of a reservation
+	///
+	struct span {
+		std::byte* data{};
+		std::size_t size{};
+	};
+
+	///
+	/// \brief Readable bytes of a record
+	///
+	struct view {
+		std::byte const* data{};
+		std::size_t size{};
+	};
+
+	///
+	/// \brief Construct a ring of (at least) capacity bytes
+	///
+	explicit byte_ring(std::size_t capacity);
+	~byte_ring() noexcept { active(false); }
+
+	byte_ring(byte_ring const&) = delete;
+	byte_ring& operator=(byte_ring const&) = delete;
+
+	///
+	/// \brief Reserve size contiguous bytes for a record, wait until room / not active
+	/// \returns std::nullopt if not active or size can never fit
+	///
+	std::optional<span> reserve(std::size_t size);
+	///
+	/// \brief Reserve size contiguous bytes for a record, if room is available
+	///
+	std::optional<span> try_reserve(std::size_t size);
+	///
+	/// \brief Publish the first size bytes of the outstanding reservation as a record and notify
+	///
+	void commit(std::size_t size);
+	///
+	/// \brief Discard the outstanding reservation
+	///
+	void abort();
+	///
+	/// \brief Copy a record into the ring and notify, wait until room / not active
+	///
+	bool push(void const* data, std::size_t size);
+	///
+	/// \brief Obtain the oldest committed record, wait until any / not active
+	///
+	std::optional<view> read();
+	///
+	/// \brief Obtain the oldest committed record, if any
+	///
+	std::optional<view> try_read();
+	///
+	/// \brief Release the outstanding read record (its bytes become available to producers)
+	///
+	void release();
+	///
+	/// \brief Obtain the largest record size that can ever fit
+	///
+	std::size_t max_record() const noexcept { return m_capacity - sizeof(header_t); }
+	std::size_t capacity() const noexcept { return m_capacity; }
+	///
+	/// \brief Obtain the number of bytes in use (records, headers, and padding)
+	///
+	std::size_t used() const;
+	///
+	/// \brief Check whether instance is active
+	///
+	bool active() const;
+	///
+	/// \brief Set active/inactive
+	///
+	void active(bool value);
+
+  private:
+	struct header_t {
+		std::uint32_t size;
+		std::uint32_t padding; // non-zero: skip to the start of the ring
+	};
+
+	static constexpr std::size_t align = alignof(header_t) < 8 ? 8 : alignof(header_t);
+
+	static std::size_t frame(std::size_t size) noexcept { return (sizeof(header_t) + size + align - 1) & ~(align - 1); }
+	std::optional<span> place(std::size_t size);
+	std::optional<view> front();
+	header_t* header(std::uint64_t pos) const noexcept { return reinterpret_cast<header_t*>(m_buffer.get() + pos % m_capacity); }
+
+	std::unique_ptr<std::byte[]> m_buffer;
+	std::size_t m_capacity{};
+	std::uint64_t m_head{};	   // read position (monotonic)
+	std::uint64_t m_tail{};	   // committed write position (monotonic)
+	std::size_t m_reserved{};  // frame size of the outstanding reservation
+	std::size_t m_reading{};   // frame size of the outstanding read (incl. any skipped padding)
+	bool m_writing{};
+	std::condition_variable m_write_cv;
+	std::condition_variable m_read_cv;
+	mutable std::mutex m_mutex;
+	bool m_active = true;
+};
+
+inline byte_ring::byte_ring(std::size_t capacity) {
+	capacity = (capacity + align - 1) & ~(align - 1);
+	if (capacity < 2 * align) { capacity = 2 * align; }
+	m_capacity = capacity;
+	m_buffer = std::make_unique<std::byte[]>(capacity);
+}
+
+inline std::optional<byte_ring::span> byte_ring::reserve(std::size_t size) {
+	if (size > max_record()) { return std::nullopt; }
+	std::optional<span> ret;
+	std::unique_lock lock(m_mutex);
+	m_write_cv.wait(lock, [this, size, &ret]() { return !m_active || (!m_writing && (ret = place(size))); });
+	if (!m_active) { return std::nullopt; }
+	return ret;
+}
+
+inline std::optional<byte_ring::span> byte_ring::try_reserve(std::size_t size) {
+	if (size > max_record()) { return std::nullopt; }
+	std::scoped_lock lock(m_mutex);
+	if (!m_active || m_writing) { return std::nullopt; }
+	return place(size);
+}
+
+inline void byte_ring::commit(std::size_t size) {
+	{
+		std::scoped_lock lock(m_mutex);
+		assert(m_writing && frame(size) <= m_reserved);
+		header_t* const head = header(m_tail);
+		*head = {static_cast<std::uint32_t>(size), 0};
+		m_tail += frame(size);
+		m_writing = false;
+	}
+	m_read_cv.notify_one();
+	// producers wait on size dependent predicates: waking one could pick a reservation that still does not fit
+	m_write_cv.notify_all();
+}
+
+inline void byte_ring::abort() {
+	{
+		std::scoped_lock lock(m_mutex);
+		assert(m_writing);
+		m_writing = false;
+	}
+	m_write_cv.notify_all();
+}
+
+inline bool byte_ring::push(void const* data, std::size_t size) {
+	auto s = reserve(size);
+	if (!s) { return false; }
+	std::memcpy(s->data, data, size);
+	commit(size);
+	return true;
+}
+
+inline std::optional<byte_ring::view> byte_ring::read() {
+	std::optional<view> ret;
+	std::unique_lock lock(m_mutex);
+	m_read_cv.wait(lock, [this, &ret]() { return !m_active || (m_reading == 0 && (ret = front())); });
+	if (!m_active) { return std::nullopt; }
+	return ret;
+}
+
+inline std::optional<byte_ring::view> byte_ring::try_read() {
+	std::scoped_lock lock(m_mutex);
+	if (!m_active || m_reading > 0) { return std::nullopt; }
+	return front();
+}
+
+inline void byte_ring::release() {
+	{
+		std::scoped_lock lock(m_mutex);
+		assert(m_reading > 0);
+		m_head += m_reading;
+		m_reading = 0;
+	}
+	m_write_cv.notify_all();
+	m_read_cv.notify_one();
+}
+
+inline std::size_t byte_ring::used() const {
+	std::scoped_lock lock(m_mutex);
+	return static_cast<std::size_t>(m_tail - m_head);
+}
+
+inline bool byte_ring::active() const {
+	std::scoped_lock lock(m_mutex);
+	return m_active;
+}
+
+inline void byte_ring::active(bool set) {
+	{
+		std::scoped_lock lock(m_mutex);
+		m_active = set;
+	}
+	m_write_cv.notify_all();
+	m_read_cv.notify_all();
+}
+
+inline std::optional<byte_ring::span> byte_ring::place(std::size_t size) {
+	std::size_t const need = frame(size);
+	std::size_t const used = static_cast<std::size_t>(m_tail - m_head);
+	std::size_t const offset = static_cast<std::size_t>(m_tail % m_capacity);
+	std::size_t const tail_room = m_capacity - offset;
+	if (need > tail_room) {
+		if (used == 0 && m_reading == 0) {
+			// empty: restart both positions at the beginning of the ring
+			m_tail += tail_room;
+			m_head = m_tail;
+		} else {
+			// pad out the end so the record is contiguous at the start
+			if (need + tail_room > m_capacity - used) { return std::nullopt; }
+			*header(m_tail) = {static_cast<std::uint32_t>(tail_room), 1};
+			m_tail += tail_room;
+		}
+	} else if (need > m_capacity - used) {
+		return std::nullopt;
+	}
+	m_writing = true;
+	m_reserved = need;
+	return span{m_buffer.get() + m_tail % m_capacity + sizeof(header_t), size};
+}
+
+inline std::optional<byte_ring::view> byte_ring::front() {
+	std::uint64_t pos = m_head;
+	std::size_t skipped{};
+	while (pos != m_tail) {
+		header_t const& head = *header(pos);
+		if (head.padding) {
+			pos += head.size;
+			skipped += head.size;
+			continue;
+		}
+		m_reading = skipped + frame(head.size);
+		return view{reinterpret_cast<std::byte const*>(&head) + sizeof(header_t), head.size};
+	}
+	return std::nullopt;
+}
+} // namespace kt
@@ -0,0 +1,233 @@
+// KT header-only library
+// Requirements: C++17
+//
+// Features:
+// 	- Task dependency graphs in flat (CSR) storage: no per-edge / per-node allocations
+// 	- Worker pool over async_queue (one queue per worker, idle workers take from others)
+// 	- Ready successors run on the worker that completed their last predecessor
+// 	- Remaining successors are pushed to that worker's queue in one batch
+//
+
+#pragma once
+#include "async_queue.hpp"
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace kt {
+///
+/// \brief Directed acyclic graph of task nodes (structure only; work is supplied to dag_executor::run)
+///
+class task_graph {
+  public:
+	using node_id = std::uint32_t;
+
+	explicit task_graph(node_id count = 0) noexcept : m_count(count) {}
+
+	///
+	/// \brief Add a new node and obtain its id
+	///
+	node_id add_node() noexcept { return m_count++; }
+	///
+	/// \brief Add count new nodes and obtain the id of the first
+	///
+	node_id add_nodes(node_id count) noexcept {
+		node_id const ret = m_count;
+		m_count += count;
+		return ret;
+	}
+	///
+	/// \brief Add a dependency: to runs only after from has completed
+	///
+	void add_edge(node_id from, node_id to) {
+		assert(from < m_count && to < m_count && from != to);
+		m_edges.push_back({from, to});
+		m_compiled = false;
+	}
+	///
+	/// \brief Reserve storage for count edges
+	///
+	void reserve_edges(std::size_t count) { m_edges.reserve(count); }
+
+	node_id size() const noexcept { return m_count; }
+	std::size_t edge_count() const noexcept { return m_edges.size(); }
+
+  private:
+	// build successor lists in compressed sparse row form (counting sort by source node)
+	void compile() {
+		if (m_compiled && m_offsets.size() == std::size_t(m_count) + 1) { return; }
+		m_offsets.assign(std::size_t(m_count) + 1, 0);
+		m_indegree.assign(m_count, 0);
+		for (auto const& [from, to] : m_edges) {
+			++m_offsets[from + 1];
+			++m_indegree[to];
+		}
+		for (node_id i = 0; i < m_count; ++i) { m_offsets[i + 1] += m_offsets[i]; }
+		m_targets.resize(m_edges.size());
+		std::vector<std::uint32_t> cursor(m_offsets.begin(), m_offsets.end() - 1);
+		for (auto const& [from, to] : m_edges) { m_targets[cursor[from]++] = to; }
+		m_compiled = true;
+	}
+
+	std::vector<std::pair<node_id, node_id>> m_edges;
+	std::vector<std::uint32_t> m_offsets;
+	std::vector<node_id> m_targets;
+	std::vector<std::uint32_t> m_indegree;
+	node_id m_count{};
+	bool m_compiled{};
+
+	friend class dag_executor;
+};
+
+///
+/// \brief Worker pool that executes a task_graph in dependency order
+///
+class dag_executor {
+  public:
+	using node_id = task_graph::node_id;
+
+	explicit dag_executor(std::uint32_t workers = std::thread::hardware_concurrency());
+	~dag_executor() noexcept;
+
+	dag_executor(dag_executor const&) = delete;
+	dag_executor& operator=(dag_executor const&) = delete;
+
+	///
+	/// \brief Execute task(node_id) for every node in graph, respecting its edges; blocks until all have completed
+	/// \param graph must be acyclic
+	/// \param task callable invoked once per node (concurrently, on worker threads)
+	/// Rethrows the first exception thrown by a task (after all nodes have been processed)
+	///
+	template <typename F>
+	void run(task_graph& graph, F&& task);
+
+	std::uint32_t worker_count() const noexcept { return static_cast<std::uint32_t>(m_threads.size()); }
+
+  private:
+	using queue_id = async_queue<node_id>::queue_id;
+
+	// non-owning range of qids (avoids allocating a container per pop_any)
+	template <typename Q>
+	struct qid_view {
+		Q const* first{};
+		Q const* last{};
+
+		Q const* begin() const noexcept { return first; }
+		Q const* end() const noexcept { return last; }
+		bool empty() const noexcept { return first == last; }
+	};
+
+	struct job_t {
+		std::function<void(node_id)> task;
+		task_graph const* graph{};
+		std::unique_ptr<std::atomic<std::uint32_t>[]> pending; // remaining dependencies per node
+		std::atomic<node_id> remaining{};						// nodes not yet completed
+		std::exception_ptr error;
+		bool done{}; // set (under mutex) by the worker completing the last node
+		std::mutex mutex;
+		std::condition_variable cv;
+	};
+
+	void work(std::uint32_t index);
+	void execute(node_id node, std::vector<node_id>& batch, queue_id qid);
+
+	async_queue<node_id> m_queue;
+	std::vector<std::vector<queue_id>> m_orders; // per worker: own qid first, then the rest
+	std::vector<std::thread> m_threads;
+	job_t* m_job{};
+	std::mutex m_run_mutex;
+};
+
+inline dag_executor::dag_executor(std::uint32_t workers) {
+	if (workers < 1) { workers = 1; }
+	for (std::uint32_t i = 1; i < workers; ++i) { m_queue.add_queue(); }
+	m_orders.resize(workers);
+	for (std::uint32_t i = 0; i < workers; ++i) {
+		for (std::uint32_t j = 0; j < workers; ++j) { m_orders[i].push_back((i + j) % workers); }
+	}
+	m_threads.reserve(workers);
+	for (std::uint32_t i = 0; i < workers; ++i) {
+		m_threads.emplace_back([this, i]() { work(i); });
+	}
+}
+
+inline dag_executor::~dag_executor() noexcept {
+	m_queue.active(false);
+	for (std::thread& thread : m_threads) { thread.join(); }
+}
+
+template <typename F>
+void dag_executor::run(task_graph& graph, F&& task) {
+	std::scoped_lock run_lock(m_run_mutex);
+	if (graph.size() == 0) { return; }
+	graph.compile();
+	job_t job;
+	job.task = std::forward<F>(task);
+	job.graph = &graph;
+	job.pending = std::make_unique<std::atomic<std::uint32_t>[]>(graph.size());
+	job.remaining = graph.size();
+	std::uint32_t const workers = worker_count();
+	std::vector<std::vector<node_id>> roots(workers);
+	for (node_id i = 0; i < graph.size(); ++i) {
+		job.pending[i].store(graph.m_indegree[i], std::memory_order_relaxed);
+		if (graph.m_indegree[i] == 0) { roots[i % workers].push_back(i); }
+	}
+	m_job = &job;
+	// job is published to workers through the queue mutex
+	for (std::uint32_t i = 0; i < workers; ++i) {
+		if (!roots[i].empty()) { m_queue.push(std::move(roots[i]), i); }
+	}
+	std::unique_lock lock(job.mutex);
+	// wait on done, not remaining: the last worker still touches job after its decrement
+	job.cv.wait(lock, [&job]() { return job.done; });
+	m_job = nullptr;
+	if (job.error) { std::rethrow_exception(job.error); }
+}
+
+inline void dag_executor::work(std::uint32_t index) {
+	auto const& order = m_orders[index];
+	qid_view<queue_id> const qids{order.data(), order.data() + order.size()};
+	std::vector<node_id> batch;
+	while (auto node = m_queue.pop_any(qids)) { execute(*node, batch, index); }
+}
+
+inline void dag_executor::execute(node_id node, std::vector<node_id>& batch, queue_id qid) {
+	job_t& job = *m_job;
+	auto const& graph = *job.graph;
+	for (;;) {
+		try {
+			job.task(node);
+		} catch (...) {
+			std::scoped_lock lock(job.mutex);
+			if (!job.error) { job.error = std::current_exception(); }
+		}
+		for (std::uint32_t e = graph.m_offsets[node]; e < graph.m_offsets[node + 1]; ++e) {
+			node_id const next = graph.m_targets[e];
+			if (job.pending[next].fetch_sub(1, std::memory_order_acq_rel) == 1) { batch.push_back(next); }
+		}
+		if (job.remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			// completion is only observable under the lock: run() cannot destroy job before this unlocks
+			std::scoped_lock lock(job.mutex);
+			job.done = true;
+			job.cv.notify_all();
+			return;
+		}
+		if (batch.empty()) { return; }
+		// keep one ready successor on this thread (warm cache), hand the rest to this worker's queue
+		node = batch.back();
+		batch.pop_back();
+		if (!batch.empty()) {
+			m_queue.push(std::move(batch), qid);
+			batch.clear();
+		}
+	}
+}
+} // namespace kt
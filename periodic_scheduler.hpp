@@ -0,0 +1,200 @@
+// KT header-only library
+// Requirements: C++17
+//
+// Features:
+// 	- Recurring schedules delivering items into async_queue qids
+// 	- Single timer thread and heap for all schedules
+// 	- Drift-free periods (next due time derived from the previous due time, not from wakeup time)
+// 	- Optional per-schedule jitter and catch-up of missed ticks
+// 	- Items due together are pushed to each qid in one batch
+//
+
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace kt {
+///
+/// \brief Timer thread that pushes items produced by recurring schedules into a Queue
+/// \param Queue async_queue type
+///
+template <typename Queue>
+class periodic_scheduler {
+  public:
+	using value_type = typename Queue::value_type;
+	using queue_id = typename Queue::queue_id;
+	using clock = std::chrono::steady_clock;
+	using schedule_id = std::uint64_t;
+
+	///
+	/// \brief Per-schedule options
+	///
+	struct options {
+		clock::duration jitter{};				// each tick is delayed by a random amount in [0, jitter] (does not accumulate)
+		std::optional<clock::duration> first{}; // delay before the first tick (default: one period)
+		bool catch_up{};						// deliver one item per missed tick instead of skipping to the next due time
+	};
+
+	explicit periodic_scheduler(Queue& queue);
+	~periodic_scheduler() noexcept;
+
+	periodic_scheduler(periodic_scheduler const&) = delete;
+	periodic_scheduler& operator=(periodic_scheduler const&) = delete;
+
+	///
+	/// \brief Push make() to qid every period
+	/// \param make callable returning value_type (invoked on the timer thread; must not call back into the scheduler)
+	///
+	template <typename F>
+	schedule_id every(clock::duration period, F&& make, queue_id qid = 0, options opts = {});
+	///
+	/// \brief Cancel a schedule
+	/// \returns false if id is not scheduled
+	///
+	bool cancel(schedule_id id);
+	///
+	/// \brief Obtain the number of active schedules
+	///
+	std::size_t size() const;
+
+  private:
+	struct entry_t {
+		std::function<value_type()> make;
+		clock::time_point due; // drift-free base (excludes jitter)
+		clock::duration period{};
+		clock::duration jitter{};
+		queue_id qid{};
+		bool catch_up{};
+	};
+
+	struct tick_t {
+		clock::time_point at;
+		schedule_id id{};
+
+		bool operator>(tick_t const& rhs) const noexcept { return at > rhs.at; }
+	};
+
+	void run();
+	void arm(schedule_id id, entry_t const& entry);
+	void advance(entry_t& entry, clock::time_point now) noexcept;
+
+	Queue& m_queue;
+	std::unordered_map<schedule_id, entry_t> m_entries;
+	std::vector<tick_t> m_ticks; // min-heap on tick_t::at
+	std::minstd_rand m_random{std::random_device{}()};
+	schedule_id m_next{};
+	std::condition_variable m_cv;
+	mutable std::mutex m_mutex;
+	bool m_stop{};
+	std::thread m_thread;
+};
+
+template <typename Queue>
+periodic_scheduler<Queue>::periodic_scheduler(Queue& queue) : m_queue(queue), m_thread([this]() { run(); }) {}
+
+template <typename Queue>
+periodic_scheduler<Queue>::~periodic_scheduler() noexcept {
+	{
+		std::scoped_lock lock(m_mutex);
+		m_stop = true;
+	}
+	m_cv.notify_all();
+	m_thread.join();
+}
+
+template <typename Queue>
+template <typename F>
+typename periodic_scheduler<Queue>::schedule_id periodic_scheduler<Queue>::every(clock::duration period, F&& make, queue_id qid, options opts) {
+	assert(period > clock::duration::zero());
+	entry_t entry;
+	entry.make = std::forward<F>(make);
+	entry.due = clock::now() + opts.first.value_or(period);
+	entry.period = period;
+	entry.jitter = opts.jitter;
+	entry.qid = qid;
+	entry.catch_up = opts.catch_up;
+	schedule_id ret{};
+	{
+		std::scoped_lock lock(m_mutex);
+		ret = m_next++;
+		arm(ret, m_entries.emplace(ret, std::move(entry)).first->second);
+	}
+	m_cv.notify_one();
+	return ret;
+}
+
+template <typename Queue>
+bool periodic_scheduler<Queue>::cancel(schedule_id id) {
+	// stale ticks are discarded lazily when they reach the top of the heap
+	std::scoped_lock lock(m_mutex);
+	return m_entries.erase(id) > 0;
+}
+
+template <typename Queue>
+std::size_t periodic_scheduler<Queue>::size() const {
+	std::scoped_lock lock(m_mutex);
+	return m_entries.size();
+}
+
+template <typename Queue>
+void periodic_scheduler<Queue>::run() {
+	std::vector<std::pair<queue_id, std::vector<value_type>>> batches;
+	std::unique_lock lock(m_mutex);
+	while (!m_stop) {
+		if (m_ticks.empty()) {
+			m_cv.wait(lock, [this]() { return m_stop || !m_ticks.empty(); });
+			continue;
+		}
+		// no predicate: a new (possibly earlier) schedule must re-evaluate the heap top
+		m_cv.wait_until(lock, m_ticks.front().at);
+		auto const now = clock::now();
+		if (m_stop || m_ticks.empty() || m_ticks.front().at > now) { continue; }
+		while (!m_ticks.empty() && m_ticks.front().at <= now) {
+			std::pop_heap(m_ticks.begin(), m_ticks.end(), std::greater<>{});
+			schedule_id const id = m_ticks.back().id;
+			m_ticks.pop_back();
+			auto it = m_entries.find(id);
+			if (it == m_entries.end()) { continue; }
+			entry_t& entry = it->second;
+			auto batch = std::find_if(batches.begin(), batches.end(), [&entry](auto const& b) { return b.first == entry.qid; });
+			if (batch == batches.end()) { batch = batches.insert(batches.end(), {entry.qid, {}}); }
+			batch->second.push_back(entry.make());
+			advance(entry, now);
+			arm(id, entry);
+		}
+		lock.unlock();
+		for (auto& [qid, items] : batches) {
+			if (!items.empty()) { m_queue.push(std::move(items), qid); }
+			items.clear();
+		}
+		lock.lock();
+	}
+}
+
+template <typename Queue>
+void periodic_scheduler<Queue>::arm(schedule_id id, entry_t const& entry) {
+	auto at = entry.due;
+	if (entry.jitter > clock::duration::zero()) { at += clock::duration(std::uniform_int_distribution<clock::rep>(0, entry.jitter.count())(m_random)); }
+	m_ticks.push_back({at, id});
+	std::push_heap(m_ticks.begin(), m_ticks.end(), std::greater<>{});
+}
+
+template <typename Queue>
+void periodic_scheduler<Queue>::advance(entry_t& entry, clock::time_point now) noexcept {
+	entry.due += entry.period;
+	if (entry.catch_up || entry.due > now) { return; }
+	// skip missed ticks, staying on the original phase
+	entry.due += entry.period * ((now - entry.due) / entry.period + 1);
+}
+} // namespace kt
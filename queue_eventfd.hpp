@@ -0,0 +1,111 @@
+// KT header-only library
+// Requirements: C++17, Linux
+//
+// Features:
+// 	- Surface async_queue push readiness through an eventfd (counter of items pushed)
+// 	- Wait on queue items and I/O completions together (epoll / poll, or an io_uring read of the eventfd)
+// 	- Optional qid filter (only pushes to watched queues signal)
+//
+// io_uring: submit a read of the eventfd (prep_read() fills the SQE without liburing, or io_uring_prep_read()
+// with fd() and 8 bytes); its completion means items were pushed. Then try_pop() until empty and resubmit the read.
+//
+
+#pragma once
+#include <cerrno>
+#include <cstdint>
+#include <sys/eventfd.h>
+#include <system_error>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#endif
+
+namespace kt {
+///
+/// \brief eventfd signalled on every push to (watched qids of) a Queue
+/// \param Queue async_queue type
+///
+/// Installs the queue's ready callback (one per queue) for its lifetime.
+/// The counter is a hint: other consumers may have popped the items, so always drain with try_pop().
+///
+template <typename Queue>
+class queue_eventfd {
+  public:
+	using queue_id = typename Queue::queue_id;
+
+	///
+	/// \brief Create a non-blocking eventfd and install the ready callback
+	/// \param qids queues to watch (empty: all)
+	/// Throws std::system_error on failure
+	///
+	explicit queue_eventfd(Queue& queue, std::vector<queue_id> const& qids = {});
+	~queue_eventfd() noexcept;
+
+	queue_eventfd(queue_eventfd const&) = delete;
+	queue_eventfd& operator=(queue_eventfd const&) = delete;
+
+	///
+	/// \brief Obtain the eventfd (readable while the counter is non-zero)
+	///
+	int fd() const noexcept { return m_fd; }
+	///
+	/// \brief Read and reset the counter
+	/// \returns Number of items pushed since the last read (0 if none)
+	///
+	std::uint64_t drain() noexcept;
+
+#if __has_include(<linux/io_uring.h>)
+	///
+	/// \brief Fill sqe with a read of the counter (result lands in completed())
+	///
+	void prep_read(io_uring_sqe& sqe, std::uint64_t user_data) noexcept {
+		sqe = {};
+		sqe.opcode = IORING_OP_READ;
+		sqe.fd = m_fd;
+		sqe.addr = reinterpret_cast<std::uint64_t>(&m_completed);
+		sqe.len = sizeof(m_completed);
+		sqe.user_data = user_data;
+	}
+#endif
+	///
+	/// \brief Obtain the counter value delivered by the last completed prep_read() read
+	///
+	std::uint64_t completed() const noexcept { return m_completed; }
+
+  private:
+	Queue& m_queue;
+	std::vector<bool> m_watched; // indexed by qid (empty: all)
+	std::uint64_t m_completed{};
+	int m_fd{-1};
+};
+
+template <typename Queue>
+queue_eventfd<Queue>::queue_eventfd(Queue& queue, std::vector<queue_id> const& qids) : m_queue(queue) {
+	m_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (m_fd < 0) { throw std::system_error(errno, std::generic_category(), "eventfd"); }
+	for (queue_id qid : qids) {
+		if (qid >= m_watched.size()) { m_watched.resize(qid + 1); }
+		m_watched[qid] = true;
+	}
+	m_queue.on_ready([this](queue_id qid, std::size_t count) {
+		if (!m_watched.empty() && (qid >= m_watched.size() || !m_watched[qid])) { return; }
+		// non-blocking: a saturated counter already signals readiness
+		::eventfd_write(m_fd, static_cast<eventfd_t>(count));
+	});
+}
+
+template <typename Queue>
+queue_eventfd<Queue>::~queue_eventfd() noexcept {
+	m_queue.on_ready({});
+	::close(m_fd);
+}
+
+template <typename Queue>
+std::uint64_t queue_eventfd<Queue>::drain() noexcept {
+	eventfd_t ret{};
+	if (::eventfd_read(m_fd, &ret) != 0) { return 0; }
+	return ret;
+}
+} // namespace kt
@@ -0,0 +1,372 @@
+// KT header-only library
+// Requirements: C++17
+//
+// Features:
+// 	- Safe memory reclamation for lock-free structures (nodes are freed only once no reader can hold them)
+// 	- Selectable policies: epoch based (cheap reads, batched frees) and hazard pointers (bounded garbage)
+// 	- Per-thread retire lists (no shared retire queue to contend on)
+// 	- RAII guards; guard records are pooled and reused across threads
+//
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace kt {
+///
+/// \brief Epoch based reclamation: readers announce the global epoch; retired nodes are freed two epochs later
+///
+/// A stalled reader blocks all reclamation (garbage is unbounded while it is pinned).
+///
+struct epoch_based {};
+
+///
+/// \brief Hazard pointer reclamation: readers publish up to Slots pointers; retired nodes are freed unless published
+/// \param Slots number of pointers a guard can protect at once
+///
+/// Each protect costs a sequentially consistent store; garbage is bounded by the number of hazard slots.
+///
+template <std::size_t Slots = 2>
+struct hazard_pointers {
+	static_assert(Slots > 0, "At least one slot required");
+};
+
+///
+/// \brief Retired node: pointer and type-erased deleter
+///
+struct retired_node {
+	void* ptr{};
+	void (*deleter)(void*){};
+	std::uint64_t epoch{}; // epoch_based only
+};
+
+namespace detail {
+inline std::atomic<std::uint64_t> g_reclaimer_id{1};
+
+struct reclaim_hint {
+	std::uint64_t domain{};
+	void* record{};
+};
+
+inline thread_local reclaim_hint t_reclaim_hint{};
+
+///
+/// \brief Guard record pool and retire list management shared by all policies
+/// \param Record policy specific per-guard state (must derive from record_base)
+///
+template <typename Record>
+class reclaim_base {
+  public:
+	struct record_base {
+		std::vector<retired_node> retired; // owned by the thread holding the record
+		Record* next{};
+		std::atomic<bool> claimed{};
+	};
+
+	reclaim_base() = default;
+	reclaim_base(reclaim_base const&) = delete;
+	reclaim_base& operator=(reclaim_base const&) = delete;
+
+	~reclaim_base() noexcept {
+		// no guards may be alive: everything outstanding is unreachable
+		Record* record = m_records.load(std::memory_order_acquire);
+		while (record) {
+			assert(!record->claimed.load());
+			for (retired_node const& node : record->retired) { node.deleter(node.ptr); }
+			delete std::exchange(record, record->next);
+		}
+	}
+
+	///
+	/// \brief Obtain the number of guard records (upper bound on concurrent guards so far)
+	///
+	std::size_t record_count() const noexcept { return m_count.load(std::memory_order_relaxed); }
+
+  protected:
+	Record* claim() {
+		// the hint record can only be dereferenced while its (never reused) domain id matches
+		auto& hint = t_reclaim_hint;
+		if (hint.domain == m_id) {
+			auto* record = static_cast<Record*>(hint.record);
+			if (!record->claimed.exchange(true, std::memory_order_acquire)) { return record; }
+		}
+		Record* ret = nullptr;
+		for (Record* record = m_records.load(std::memory_order_acquire); record; record = record->next) {
+			if (!record->claimed.load(std::memory_order_relaxed) && !record->claimed.exchange(true, std::memory_order_acquire)) {
+				ret = record;
+				break;
+			}
+		}
+		if (!ret) {
+			ret = new Record;
+			ret->claimed.store(true, std::memory_order_relaxed);
+			ret->next = m_records.load(std::memory_order_relaxed);
+			while (!m_records.compare_exchange_weak(ret->next, ret, std::memory_order_release, std::memory_order_relaxed)) {}
+			m_count.fetch_add(1, std::memory_order_relaxed);
+		}
+		hint = {m_id, ret};
+		return ret;
+	}
+
+	void unclaim(Record* record) noexcept { record->claimed.store(false, std::memory_order_release); }
+
+	template <typename F>
+	void for_each_record(F&& f) const {
+		for (Record* record = m_records.load(std::memory_order_acquire); record; record = record->next) { f(*record); }
+	}
+
+	// frees retired nodes in list for which pred(node) holds, keeping the rest
+	template <typename Pred>
+	static void free_if(std::vector<retired_node>& list, Pred pred) {
+		auto it = std::partition(list.begin(), list.end(), [&pred](retired_node const& node) { return !pred(node); });
+		for (auto node = it; node != list.end(); ++node) { node->deleter(node->ptr); }
+		list.erase(it, list.end());
+	}
+
+	template <typename T>
+	static retired_node make_node(T* ptr) noexcept {
+		return {ptr, [](void* p) { delete static_cast<T*>(p); }};
+	}
+
+	std::atomic<Record*> m_records{};
+	std::atomic<std::size_t> m_count{};
+	std::uint64_t const m_id = g_reclaimer_id.fetch_add(1, std::memory_order_relaxed);
+};
+
+struct epoch_record;
+template <std::size_t Slots>
+struct hazard_record;
+} // namespace detail
+
+///
+/// \brief Reclamation domain: readers pin() a guard around accesses; writers retire() unlinked nodes
+/// \param Policy epoch_based or hazard_pointers<Slots>
+///
+template <typename Policy = epoch_based>
+class reclaimer;
+
+namespace detail {
+struct epoch_record : reclaim_base<epoch_record>::record_base {
+	std::atomic<std::uint64_t> epoch{}; // 0: not pinned
+	std::uint64_t collected{};			 // global epoch at the last collection (owned with the record)
+};
+} // namespace detail
+
+template <>
+class reclaimer<epoch_based> : public detail::reclaim_base<detail::epoch_record> {
+  public:
+	using policy_type = epoch_based;
+
+	///
+	/// \brief Retire list length that triggers an epoch advance / collection attempt
+	///
+	static constexpr std::size_t retire_threshold = 64;
+
+	///
+	/// \brief RAII critical section; pointers loaded through it stay valid until it is destroyed
+	///
+	class guard {
+	  public:
+		guard(guard&& rhs) noexcept : m_domain(std::exchange(rhs.m_domain, nullptr)), m_record(std::exchange(rhs.m_record, nullptr)) {}
+		guard& operator=(guard&&) = delete;
+		~guard() noexcept {
+			if (!m_record) { return; }
+			m_record->epoch.store(0, std::memory_order_release);
+			m_domain->unclaim(m_record);
+		}
+
+		///
+		/// \brief Load a shared pointer (slot is ignored under this policy)
+		///
+		template <typename T>
+		T* protect(std::atomic<T*> const& src, std::size_t = 0) const noexcept {
+			return src.load(std::memory_order_acquire);
+		}
+		///
+		/// \brief Retire an unlinked node (deleted once no guard can hold it)
+		///
+		template <typename T>
+		void retire(T* ptr) {
+			retire(make_node(ptr));
+		}
+		void retire(retired_node node);
+
+	  private:
+		guard(reclaimer& domain, detail::epoch_record* record) noexcept : m_domain(&domain), m_record(record) {}
+
+		reclaimer* m_domain;
+		detail::epoch_record* m_record;
+
+		friend class reclaimer;
+	};
+
+	///
+	/// \brief Enter a critical section
+	///
+	guard pin();
+	///
+	/// \brief Try to advance the epoch and free the calling guard's eligible nodes
+	///
+	void collect(guard& g) { collect(*g.m_record); }
+	///
+	/// \brief Obtain the current global epoch
+	///
+	std::uint64_t epoch() const noexcept { return m_epoch.load(std::memory_order_acquire); }
+
+  private:
+	bool try_advance(std::uint64_t current);
+	void collect(detail::epoch_record& record);
+
+	std::atomic<std::uint64_t> m_epoch{1};
+};
+
+inline reclaimer<epoch_based>::guard reclaimer<epoch_based>::pin() {
+	auto* record = claim();
+	// seq_cst: the announcement must be visible before any shared load in the critical section
+	record->epoch.store(m_epoch.load(std::memory_order_acquire), std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	return guard(*this, record);
+}
+
+inline void reclaimer<epoch_based>::guard::retire(retired_node node) {
+	node.epoch = m_domain->m_epoch.load(std::memory_order_acquire);
+	m_record->retired.push_back(node);
+	if (m_record->retired.size() >= retire_threshold) { m_domain->collect(*m_record); }
+}
+
+inline bool reclaimer<epoch_based>::try_advance(std::uint64_t current) {
+	bool ready = true;
+	for_each_record([current, &ready](detail::epoch_record const& record) {
+		auto const epoch = record.epoch.load(std::memory_order_seq_cst);
+		if (epoch != 0 && epoch != current) { ready = false; }
+	});
+	if (!ready) { return false; }
+	return m_epoch.compare_exchange_strong(current, current + 1, std::memory_order_acq_rel);
+}
+
+inline void reclaimer<epoch_based>::collect(detail::epoch_record& record) {
+	auto current = m_epoch.load(std::memory_order_acquire);
+	if (try_advance(current)) { ++current; }
+	// no node becomes eligible until the epoch moves (a stalled reader must not make every retire walk the list)
+	if (current == record.collected) { return; }
+	record.collected = current;
+	// a node retired in epoch e may still be held by readers pinned at e or e - 1 (not at e + 1)
+	// retire order is epoch order: eligible nodes form a prefix
+	auto const end = std::find_if(record.retired.begin(), record.retired.end(), [current](retired_node const& node) { return node.epoch + 2 > current; });
+	for (auto node = record.retired.begin(); node != end; ++node) { node->deleter(node->ptr); }
+	record.retired.erase(record.retired.begin(), end);
+}
+
+namespace detail {
+template <std::size_t Slots>
+struct hazard_record : reclaim_base<hazard_record<Slots>>::record_base {
+	std::atomic<void*> hazards[Slots]{};
+};
+} // namespace detail
+
+template <std::size_t Slots>
+class reclaimer<hazard_pointers<Slots>> : public detail::reclaim_base<detail::hazard_record<Slots>> {
+	using base_t = detail::reclaim_base<detail::hazard_record<Slots>>;
+	using record_t = detail::hazard_record<Slots>;
+
+  public:
+	using policy_type = hazard_pointers<Slots>;
+
+	///
+	/// \brief Minimum retire list length that triggers a scan (also scales with the number of hazard slots)
+	///
+	static constexpr std::size_t retire_threshold = 64;
+
+	///
+	/// \brief RAII owner of Slots hazard pointers
+	///
+	class guard {
+	  public:
+		guard(guard&& rhs) noexcept : m_domain(std::exchange(rhs.m_domain, nullptr)), m_record(std::exchange(rhs.m_record, nullptr)) {}
+		guard& operator=(guard&&) = delete;
+		~guard() noexcept {
+			if (!m_record) { return; }
+			for (auto& hazard : m_record->hazards) { hazard.store(nullptr, std::memory_order_release); }
+			m_domain->unclaim(m_record);
+		}
+
+		///
+		/// \brief Load a shared pointer and protect it in slot (replacing whatever the slot protected)
+		///
+		template <typename T>
+		T* protect(std::atomic<T*> const& src, std::size_t slot = 0) const noexcept;
+		///
+		/// \brief Stop protecting the pointer in slot
+		///
+		void clear(std::size_t slot) const noexcept { m_record->hazards[slot].store(nullptr, std::memory_order_release); }
+		///
+		/// \brief Retire an unlinked node (deleted once no slot publishes it)
+		///
+		template <typename T>
+		void retire(T* ptr) {
+			retire(base_t::make_node(ptr));
+		}
+		void retire(retired_node node);
+
+	  private:
+		guard(reclaimer& domain, record_t* record) noexcept : m_domain(&domain), m_record(record) {}
+
+		reclaimer* m_domain;
+		record_t* m_record;
+
+		friend class reclaimer;
+	};
+
+	///
+	/// \brief Obtain a guard (its slots start out empty)
+	///
+	guard pin() { return guard(*this, this->claim()); }
+	///
+	/// \brief Free the calling guard's retired nodes that no slot publishes
+	///
+	void collect(guard& g) { scan(*g.m_record); }
+
+  private:
+	void scan(record_t& record);
+};
+
+template <std::size_t Slots>
+template <typename T>
+T* reclaimer<hazard_pointers<Slots>>::guard::protect(std::atomic<T*> const& src, std::size_t slot) const noexcept {
+	assert(slot < Slots);
+	T* ret = src.load(std::memory_order_relaxed);
+	for (;;) {
+		// publish, then validate that src still holds it (a retire after this point will observe the hazard)
+		m_record->hazards[slot].store(ret, std::memory_order_seq_cst);
+		T* const check = src.load(std::memory_order_seq_cst);
+		if (check == ret) { return ret; }
+		ret = check;
+	}
+}
+
+template <std::size_t Slots>
+void reclaimer<hazard_pointers<Slots>>::guard::retire(retired_node node) {
+	m_record->retired.push_back(node);
+	std::size_t const threshold = std::max(retire_threshold, 2 * Slots * m_domain->record_count());
+	if (m_record->retired.size() >= threshold) { m_domain->scan(*m_record); }
+}
+
+template <std::size_t Slots>
+void reclaimer<hazard_pointers<Slots>>::scan(record_t& record) {
+	std::vector<void*> hazards;
+	hazards.reserve(Slots * this->record_count());
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	this->for_each_record([&hazards](record_t const& r) {
+		for (auto const& hazard : r.hazards) {
+			if (void* ptr = hazard.load(std::memory_order_seq_cst)) { hazards.push_back(ptr); }
+		}
+	});
+	std::sort(hazards.begin(), hazards.end());
+	base_t::free_if(record.retired, [&hazards](retired_node const& node) { return !std::binary_search(hazards.begin(), hazards.end(), node.ptr); });
+}
+} // namespace kt
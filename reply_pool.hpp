@@ -0,0 +1,186 @@
+// KT header-only library
+// Requirements: C++17
+//
+// Features:
+// 	- Pre-allocated pool of reply slots for request / reply over async_queue
+// 	- O(1) correlation of replies to waiters (slot index + generation)
+// 	- Per-slot wakeup (only the waiting caller is notified)
+// 	- Stale replies (after timeout / release) are rejected
+//
+
+#pragma once
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace kt {
+///
+/// \brief Fixed capacity pool of reply slots, addressed by correlation id
+/// \param R reply type
+///
+/// Typical use: acquire() an id, push a request carrying it, wait() on the id;
+/// the responder calls reply() with the id from the request.
+///
+template <typename R>
+class reply_pool {
+  public:
+	using value_type = R;
+	///
+	/// \brief Correlation id (generation in the high 32 bits, slot index in the low 32 bits)
+	///
+	using correlation_id = std::uint64_t;
+
+	explicit reply_pool(std::uint32_t capacity);
+
+	///
+	/// \brief Obtain a free slot's correlation id, wait until one is available
+	///
+	correlation_id acquire();
+	///
+	/// \brief Obtain a free slot's correlation id, if any are available
+	///
+	std::optional<correlation_id> try_acquire();
+	///
+	/// \brief Deliver a reply and wake its waiter
+	/// \returns false if id is stale (released / timed out) or already replied to
+	///
+	bool reply(correlation_id id, R r);
+	///
+	/// \brief Wait for the reply to id and release its slot
+	///
+	R wait(correlation_id id);
+	///
+	/// \brief Wait for the reply to id until timeout and release its slot
+	/// \returns std::nullopt on timeout (late replies are then rejected)
+	///
+	template <typename Rep, typename Period>
+	std::optional<R> wait_for(correlation_id id, std::chrono::duration<Rep, Period> timeout);
+	///
+	/// \brief Release the slot for id without waiting (late replies are then rejected)
+	///
+	void release(correlation_id id);
+	///
+	/// \brief Obtain the total number of slots
+	///
+	std::uint32_t capacity() const noexcept { return m_capacity; }
+
+  private:
+	struct slot_t {
+		std::optional<R> value;
+		std::condition_variable cv;
+		std::mutex mutex;
+		std::uint32_t generation{};
+		bool pending{};
+	};
+
+	static std::uint32_t index(correlation_id id) noexcept { return static_cast<std::uint32_t>(id); }
+	static std::uint32_t generation(correlation_id id) noexcept { return static_cast<std::uint32_t>(id >> 32); }
+	correlation_id open(std::uint32_t index);
+	std::optional<R> close(slot_t& slot, std::uint32_t index);
+
+	std::unique_ptr<slot_t[]> m_slots;
+	std::vector<std::uint32_t> m_free;
+	std::condition_variable m_cv;
+	std::mutex m_mutex;
+	std::uint32_t m_capacity;
+};
+
+template <typename R>
+reply_pool<R>::reply_pool(std::uint32_t capacity) : m_slots(std::make_unique<slot_t[]>(capacity)), m_capacity(capacity) {
+	assert(capacity > 0);
+	m_free.reserve(capacity);
+	for (std::uint32_t i = capacity; i > 0; --i) { m_free.push_back(i - 1); }
+}
+
+template <typename R>
+typename reply_pool<R>::correlation_id reply_pool<R>::acquire() {
+	std::unique_lock lock(m_mutex);
+	m_cv.wait(lock, [this]() { return !m_free.empty(); });
+	std::uint32_t const ret = m_free.back();
+	m_free.pop_back();
+	lock.unlock();
+	return open(ret);
+}
+
+template <typename R>
+std::optional<typename reply_pool<R>::correlation_id> reply_pool<R>::try_acquire() {
+	std::unique_lock lock(m_mutex);
+	if (m_free.empty()) { return std::nullopt; }
+	std::uint32_t const ret = m_free.back();
+	m_free.pop_back();
+	lock.unlock();
+	return open(ret);
+}
+
+template <typename R>
+bool reply_pool<R>::reply(correlation_id id, R r) {
+	if (index(id) >= m_capacity) { return false; }
+	slot_t& slot = m_slots[index(id)];
+	{
+		std::scoped_lock lock(slot.mutex);
+		if (!slot.pending || slot.generation != generation(id) || slot.value) { return false; }
+		slot.value = std::move(r);
+	}
+	slot.cv.notify_one();
+	return true;
+}
+
+template <typename R>
+R reply_pool<R>::wait(correlation_id id) {
+	assert(index(id) < m_capacity);
+	slot_t& slot = m_slots[index(id)];
+	std::unique_lock lock(slot.mutex);
+	assert(slot.pending && slot.generation == generation(id));
+	slot.cv.wait(lock, [&slot]() { return slot.value.has_value(); });
+	auto ret = close(slot, index(id));
+	lock.unlock();
+	return std::move(*ret);
+}
+
+template <typename R>
+template <typename Rep, typename Period>
+std::optional<R> reply_pool<R>::wait_for(correlation_id id, std::chrono::duration<Rep, Period> timeout) {
+	assert(index(id) < m_capacity);
+	slot_t& slot = m_slots[index(id)];
+	std::unique_lock lock(slot.mutex);
+	assert(slot.pending && slot.generation == generation(id));
+	slot.cv.wait_for(lock, timeout, [&slot]() { return slot.value.has_value(); });
+	return close(slot, index(id));
+}
+
+template <typename R>
+void reply_pool<R>::release(correlation_id id) {
+	assert(index(id) < m_capacity);
+	slot_t& slot = m_slots[index(id)];
+	std::scoped_lock lock(slot.mutex);
+	if (slot.pending && slot.generation == generation(id)) { close(slot, index(id)); }
+}
+
+template <typename R>
+typename reply_pool<R>::correlation_id reply_pool<R>::open(std::uint32_t index) {
+	slot_t& slot = m_slots[index];
+	std::scoped_lock lock(slot.mutex);
+	slot.pending = true;
+	return (static_cast<correlation_id>(slot.generation) << 32) | index;
+}
+
+template <typename R>
+std::optional<R> reply_pool<R>::close(slot_t& slot, std::uint32_t index) {
+	// caller holds slot.mutex; bumping the generation invalidates the id for late replies
+	std::optional<R> ret = std::move(slot.value);
+	slot.value.reset();
+	slot.pending = false;
+	++slot.generation;
+	{
+		std::scoped_lock lock(m_mutex);
+		m_free.push_back(index);
+	}
+	m_cv.notify_one();
+	return ret;
+}
+} // namespace kt
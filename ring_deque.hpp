@@ -0,0 +1,295 @@
+// KT header-only library
+// Requirements: C++17
+//
+// Features:
+// 	- Double-ended queue in one contiguous circular buffer (std::deque compatible subset)
+// 	- reserve(): allocate (and pre-fault) storage up front; capacity is kept across clear() / pops
+// 	- Random access iterators (usable with heap algorithms)
+//
+
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace kt {
+///
+/// \brief Circular buffer deque whose storage only grows (until shrink_to_fit())
+/// \param T value type
+/// \param Alloc allocator
+///
+/// Unlike std::deque, growing beyond capacity() relocates all elements (invalidating references).
+///
+template <typename T, typename Alloc = std::allocator<T>>
+class ring_deque {
+	using traits_t = std::allocator_traits<Alloc>;
+
+	template <bool Const>
+	class iter_t;
+
+  public:
+	using value_type = T;
+	using allocator_type = Alloc;
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using reference = T&;
+	using const_reference = T const&;
+	using iterator = iter_t<false>;
+	using const_iterator = iter_t<true>;
+
+	ring_deque() = default;
+	explicit ring_deque(Alloc const& alloc) noexcept : m_alloc(alloc) {}
+	ring_deque(ring_deque const& rhs) : m_alloc(traits_t::select_on_container_copy_construction(rhs.m_alloc)) {
+		reserve(rhs.size());
+		for (T const& t : rhs) { push_back(t); }
+	}
+	ring_deque(ring_deque&& rhs) noexcept : m_alloc(std::move(rhs.m_alloc)) { steal(rhs); }
+	ring_deque& operator=(ring_deque rhs) noexcept {
+		swap(rhs);
+		return *this;
+	}
+	~ring_deque() noexcept { release(); }
+
+	void swap(ring_deque& rhs) noexcept {
+		using std::swap;
+		swap(m_alloc, rhs.m_alloc);
+		swap(m_data, rhs.m_data);
+		swap(m_capacity, rhs.m_capacity);
+		swap(m_head, rhs.m_head);
+		swap(m_size, rhs.m_size);
+	}
+	friend void swap(ring_deque& lhs, ring_deque& rhs) noexcept { lhs.swap(rhs); }
+
+	size_type size() const noexcept { return m_size; }
+	bool empty() const noexcept { return m_size == 0; }
+	size_type capacity() const noexcept { return m_capacity; }
+	allocator_type get_allocator() const noexcept { return m_alloc; }
+
+	T& operator[](size_type i) noexcept { return m_data[wrap(m_head + i)]; }
+	T const& operator[](size_type i) const noexcept { return m_data[wrap(m_head + i)]; }
+	T& front() noexcept { return (*this)[0]; }
+	T const& front() const noexcept { return (*this)[0]; }
+	T& back() noexcept { return (*this)[m_size - 1]; }
+	T const& back() const noexcept { return (*this)[m_size - 1]; }
+
+	iterator begin() noexcept { return {this, 0}; }
+	iterator end() noexcept { return {this, m_size}; }
+	const_iterator begin() const noexcept { return {this, 0}; }
+	const_iterator end() const noexcept { return {this, m_size}; }
+	const_iterator cbegin() const noexcept { return begin(); }
+	const_iterator cend() const noexcept { return end(); }
+
+	void push_back(T const& t) { emplace_back(t); }
+	void push_back(T&& t) { emplace_back(std::move(t)); }
+	template <typename... U>
+	T& emplace_back(U&&... u);
+	void pop_front() noexcept;
+	void pop_back() noexcept;
+	///
+	/// \brief Destroy all elements (capacity is retained)
+	///
+	void clear() noexcept;
+	iterator erase(const_iterator first, const_iterator last);
+	iterator insert(const_iterator pos, size_type count, T const& t);
+	void assign(size_type count, T const& t);
+	void resize(size_type count);
+	void resize(size_type count, T const& t);
+	///
+	/// \brief Ensure capacity for count elements, touching every page of the (new) storage
+	///
+	void reserve(size_type count);
+	///
+	/// \brief Reduce capacity to fit size() (frees storage if empty)
+	///
+	void shrink_to_fit();
+
+  private:
+	template <bool Const>
+	class iter_t {
+		using owner_t = std::conditional_t<Const, ring_deque const, ring_deque>;
+
+	  public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = T;
+		using difference_type = std::ptrdiff_t;
+		using pointer = std::conditional_t<Const, T const*, T*>;
+		using reference = std::conditional_t<Const, T const&, T&>;
+
+		iter_t() = default;
+		iter_t(owner_t* owner, size_type index) noexcept : m_owner(owner), m_index(index) {}
+		template <bool C = Const, typename = std::enable_if_t<C>>
+		iter_t(iter_t<false> const& rhs) noexcept : m_owner(rhs.m_owner), m_index(rhs.m_index) {}
+
+		reference operator*() const noexcept { return (*m_owner)[m_index]; }
+		pointer operator->() const noexcept { return &(*m_owner)[m_index]; }
+		reference operator[](difference_type n) const noexcept { return (*m_owner)[m_index + static_cast<size_type>(n)]; }
+
+		iter_t& operator++() noexcept { return ++m_index, *this; }
+		iter_t& operator--() noexcept { return --m_index, *this; }
+		iter_t operator++(int) noexcept { return {m_owner, m_index++}; }
+		iter_t operator--(int) noexcept { return {m_owner, m_index--}; }
+		iter_t& operator+=(difference_type n) noexcept { return m_index += static_cast<size_type>(n), *this; }
+		iter_t& operator-=(difference_type n) noexcept { return m_index -= static_cast<size_type>(n), *this; }
+		friend iter_t operator+(iter_t it, difference_type n) noexcept { return it += n; }
+		friend iter_t operator+(difference_type n, iter_t it) noexcept { return it += n; }
+		friend iter_t operator-(iter_t it, difference_type n) noexcept { return it -= n; }
+		friend difference_type operator-(iter_t const& a, iter_t const& b) noexcept { return static_cast<difference_type>(a.m_index) - static_cast<difference_type>(b.m_index); }
+
+		friend bool operator==(iter_t const& a, iter_t const& b) noexcept { return a.m_index == b.m_index; }
+		friend bool operator!=(iter_t const& a, iter_t const& b) noexcept { return a.m_index != b.m_index; }
+		friend bool operator<(iter_t const& a, iter_t const& b) noexcept { return a.m_index < b.m_index; }
+		friend bool operator>(iter_t const& a, iter_t const& b) noexcept { return a.m_index > b.m_index; }
+		friend bool operator<=(iter_t const& a, iter_t const& b) noexcept { return a.m_index <= b.m_index; }
+		friend bool operator>=(iter_t const& a, iter_t const& b) noexcept { return a.m_index >= b.m_index; }
+
+	  private:
+		owner_t* m_owner{};
+		size_type m_index{};
+
+		friend class ring_deque;
+	};
+
+	size_type wrap(size_type i) const noexcept { return i & (m_capacity - 1); }
+	T* slot(size_type i) noexcept { return m_data + wrap(m_head + i); }
+	void relocate(size_type capacity);
+	void steal(ring_deque& rhs) noexcept {
+		m_data = std::exchange(rhs.m_data, nullptr);
+		m_capacity = std::exchange(rhs.m_capacity, 0);
+		m_head = std::exchange(rhs.m_head, 0);
+		m_size = std::exchange(rhs.m_size, 0);
+	}
+	void release() noexcept {
+		clear();
+		if (m_data) { traits_t::deallocate(m_alloc, std::exchange(m_data, nullptr), std::exchange(m_capacity, 0)); }
+	}
+
+	Alloc m_alloc{};
+	T* m_data{};
+	size_type m_capacity{}; // 0 or a power of two
+	size_type m_head{};
+	size_type m_size{};
+};
+
+template <typename T, typename Alloc>
+template <typename... U>
+T& ring_deque<T, Alloc>::emplace_back(U&&... u) {
+	if (m_size == m_capacity) { relocate(m_capacity == 0 ? 8 : 2 * m_capacity); }
+	T* const ret = slot(m_size);
+	traits_t::construct(m_alloc, ret, std::forward<U>(u)...);
+	++m_size;
+	return *ret;
+}
+
+template <typename T, typename Alloc>
+void ring_deque<T, Alloc>::pop_front() noexcept {
+	assert(m_size > 0);
+	traits_t::destroy(m_alloc, slot(0));
+	m_head = wrap(m_head + 1);
+	--m_size;
+}
+
+template <typename T, typename Alloc>
+void ring_deque<T, Alloc>::pop_back() noexcept {
+	assert(m_size > 0);
+	traits_t::destroy(m_alloc, slot(m_size - 1));
+	--m_size;
+}
+
+template <typename T, typename Alloc>
+void ring_deque<T, Alloc>::clear() noexcept {
+	while (m_size > 0) { pop_back(); }
+	m_head = 0;
+}
+
+template <typename T, typename Alloc>
+typename ring_deque<T, Alloc>::iterator ring_deque<T, Alloc>::erase(const_iterator first, const_iterator last) {
+	size_type const from = first.m_index;
+	size_type const count = last.m_index - first.m_index;
+	if (count == 0) { return {this, from}; }
+	std::move(begin() + static_cast<difference_type>(last.m_index), end(), begin() + static_cast<difference_type>(from));
+	for (size_type i = 0; i < count; ++i) { pop_back(); }
+	return {this, from};
+}
+
+template <typename T, typename Alloc>
+typename ring_deque<T, Alloc>::iterator ring_deque<T, Alloc>::insert(const_iterator pos, size_type count, T const& t) {
+	size_type const at = pos.m_index;
+	size_type const old_size = m_size;
+	reserve(m_size + count);
+	for (size_type i = 0; i < count; ++i) { emplace_back(t); }
+	// appended at the back: rotate into place (no-op when inserting at end())
+	std::rotate(begin() + static_cast<difference_type>(at), begin() + static_cast<difference_type>(old_size), end());
+	return {this, at};
+}
+
+template <typename T, typename Alloc>
+void ring_deque<T, Alloc>::assign(size_type count, T const& t) {
+	clear();
+	insert(end(), count, t);
+}
+
+template <typename T, typename Alloc>
+void ring_deque<T, Alloc>::resize(size_type count) {
+	while (m_size > count) { pop_back(); }
+	reserve(count);
+	while (m_size < count) { emplace_back(); }
+}
+
+template <typename T, typename Alloc>
+void ring_deque<T, Alloc>::resize(size_type count, T const& t) {
+	while (m_size > count) { pop_back(); }
+	reserve(count);
+	while (m_size < count) { emplace_back(t); }
+}
+
+template <typename T, typename Alloc>
+void ring_deque<T, Alloc>::reserve(size_type count) {
+	if (count <= m_capacity) { return; }
+	size_type capacity = 8;
+	while (capacity < count) { capacity *= 2; }
+	relocate(capacity);
+	// pre-fault: write one byte per page of the unused slots (raw storage, no objects live there)
+	constexpr size_type page = 4096;
+	for (size_type i = m_size; i < m_capacity;) {
+		auto* const bytes = reinterpret_cast<unsigned char volatile*>(slot(i));
+		*bytes = 0;
+		i += std::max<size_type>(1, page / sizeof(T));
+	}
+}
+
+template <typename T, typename Alloc>
+void ring_deque<T, Alloc>::shrink_to_fit() {
+	if (m_size == 0) {
+		release();
+		m_head = 0;
+		return;
+	}
+	size_type capacity = 8;
+	while (capacity < m_size) { capacity *= 2; }
+	if (capacity < m_capacity) { relocate(capacity); }
+}
+
+template <typename T, typename Alloc>
+void ring_deque<T, Alloc>::relocate(size_type capacity) {
+	assert(capacity >= m_size && (capacity & (capacity - 1)) == 0);
+	T* const data = traits_t::allocate(m_alloc, capacity);
+	size_type moved{};
+	try {
+		for (; moved < m_size; ++moved) { traits_t::construct(m_alloc, data + moved, std::move_if_noexcept((*this)[moved])); }
+	} catch (...) {
+		while (moved > 0) { traits_t::destroy(m_alloc, data + --moved); }
+		traits_t::deallocate(m_alloc, data, capacity);
+		throw;
+	}
+	size_type const size = m_size;
+	release();
+	m_data = data;
+	m_capacity = capacity;
+	m_head = 0;
+	m_size = size;
+}
+} // namespace kt
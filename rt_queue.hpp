@@ -0,0 +1,243 @@
+// KT header-only library
+// Requirements: C++17 (optional memory locking: POSIX)
+//
+// Features:
+// 	- Multiple fixed capacity queues, all storage allocated (and optionally locked in RAM) at construction
+// 	- Allocation-free, try-only push / pop for real-time threads (never wait on a contended lock)
+// 	- Bounded lock hold: every operation moves at most one T under the lock
+// 	- Blocking pop for non real-time consumers
+// 	- Compile-time rejection of value types whose move / destruction may allocate or free (see rt_safe)
+//
+
+#pragma once
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#if __has_include(<sys/mman.h>)
+#include <sys/mman.h>
+#endif
+
+namespace kt {
+///
+/// \brief Whether T can be moved and destroyed on a real-time thread (no allocation / deallocation)
+///
+/// Defaults to trivially copyable types; specialize for other types that never own heap memory.
+///
+template <typename T>
+struct rt_safe : std::is_trivially_copyable<T> {};
+
+template <typename T>
+constexpr bool rt_safe_v = rt_safe<T>::value;
+
+///
+/// \brief Preallocated multi-queue for real-time producers / consumers
+/// \param T value type (must satisfy rt_safe)
+///
+/// try_push / try_pop never allocate and never block: they return false / std::nullopt if the queue is
+/// full / empty or the lock is momentarily held by another thread (retry on the next cycle).
+///
+template <typename T>
+class rt_queue {
+	static_assert(rt_safe_v<T>, "T may allocate / free when moved or destroyed: specialize kt::rt_safe<T> if it does not");
+	static_assert(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_destructible_v<T>, "T must be nothrow movable and destructible");
+
+  public:
+	using value_type = T;
+	using queue_id = std::size_t;
+
+	///
+	/// \brief Construction options
+	///
+	struct options {
+		bool prefault = true; // touch every page of storage up front
+		bool lock_memory{};	  // mlock storage (see memory_locked())
+	};
+
+	///
+	/// \brief Allocate capacity slots for each of qcount queues
+	///
+	explicit rt_queue(std::size_t capacity, std::uint8_t qcount = 1, options opts = {});
+	~rt_queue() noexcept;
+
+	rt_queue(rt_queue const&) = delete;
+	rt_queue& operator=(rt_queue const&) = delete;
+
+	///
+	/// \brief Move a T to the back of desired queue and notify (never allocates / blocks)
+	/// \returns false if full / contended / not active
+	///
+	bool try_push(T&& t, queue_id qid = 0) noexcept { return try_emplace(qid, std::move(t)); }
+	///
+	/// \brief Copy a T to the back of desired queue and notify (never allocates / blocks)
+	/// \returns false if full / contended / not active
+	///
+	bool try_push(T const& t, queue_id qid = 0) noexcept { return try_emplace(qid, t); }
+	///
+	/// \brief Construct a T at the back of desired queue and notify (never allocates / blocks)
+	/// \returns false if full / contended / not active
+	///
+	template <typename... U>
+	bool try_emplace(queue_id qid, U&&... u) noexcept;
+	///
+	/// \brief Pop a T from the front of desired queue (never allocates / blocks)
+	/// \returns std::nullopt if empty / contended / not active
+	///
+	std::optional<T> try_pop(queue_id qid = 0) noexcept;
+	///
+	/// \brief Pop a T from the front of desired queue, wait until populated / not active (not for real-time threads)
+	///
+	std::optional<T> pop(queue_id qid = 0);
+	///
+	/// \brief Obtain the number of items in desired queue
+	///
+	std::size_t size(queue_id qid) const;
+
+	std::size_t capacity() const noexcept { return m_capacity; }
+	std::size_t queue_count() const noexcept { return m_qcount; }
+	///
+	/// \brief Check whether storage was locked in RAM (options::lock_memory)
+	///
+	bool memory_locked() const noexcept { return m_locked; }
+	///
+	/// \brief Check whether instance is active
+	///
+	bool active() const;
+	///
+	/// \brief Set active/inactive
+	///
+	void active(bool value);
+
+  private:
+	struct alignas(T) slot_t {
+		std::byte bytes[sizeof(T)];
+	};
+
+	struct ring_t {
+		std::size_t head{};
+		std::size_t count{};
+	};
+
+	// raw bytes of a slot (construct into these); slot() is only valid once a T lives there
+	void* storage(queue_id qid, std::size_t index) noexcept { return m_slots[qid * m_capacity + index % m_capacity].bytes; }
+	T* slot(queue_id qid, std::size_t index) noexcept { return std::launder(static_cast<T*>(storage(qid, index))); }
+	T take(queue_id qid) noexcept;
+
+	std::unique_ptr<slot_t[]> m_slots;
+	std::unique_ptr<ring_t[]> m_rings;
+	std::size_t m_capacity;
+	std::size_t m_qcount;
+	std::size_t m_waiters{};
+	std::condition_variable m_cv;
+	mutable std::mutex m_mutex;
+	bool m_active = true;
+	bool m_locked{};
+};
+
+template <typename T>
+rt_queue<T>::rt_queue(std::size_t capacity, std::uint8_t qcount, options opts)
+	: m_capacity(capacity < 1 ? 1 : capacity), m_qcount(qcount < 1 ? 1 : qcount) {
+	m_slots = std::make_unique<slot_t[]>(m_capacity * m_qcount);
+	m_rings = std::make_unique<ring_t[]>(m_qcount);
+	std::size_t const bytes = m_capacity * m_qcount * sizeof(slot_t);
+	if (opts.prefault) { std::memset(m_slots.get(), 0, bytes); }
+#if __has_include(<sys/mman.h>)
+	if (opts.lock_memory) { m_locked = ::mlock(m_slots.get(), bytes) == 0 && ::mlock(m_rings.get(), m_qcount * sizeof(ring_t)) == 0; }
+#endif
+}
+
+template <typename T>
+rt_queue<T>::~rt_queue() noexcept {
+	active(false);
+	for (queue_id qid = 0; qid < m_qcount; ++qid) {
+		while (m_rings[qid].count > 0) { take(qid); }
+	}
+#if __has_include(<sys/mman.h>)
+	if (m_locked) {
+		::munlock(m_slots.get(), m_capacity * m_qcount * sizeof(slot_t));
+		::munlock(m_rings.get(), m_qcount * sizeof(ring_t));
+	}
+#endif
+}
+
+template <typename T>
+template <typename... U>
+bool rt_queue<T>::try_emplace(queue_id qid, U&&... u) noexcept {
+	static_assert(std::is_nothrow_constructible_v<T, U...>, "T must be nothrow constructible from U...");
+	assert(qid < m_qcount);
+	bool notify{};
+	{
+		std::unique_lock lock(m_mutex, std::try_to_lock);
+		if (!lock || !m_active) { return false; }
+		ring_t& ring = m_rings[qid];
+		if (ring.count == m_capacity) { return false; }
+		new (storage(qid, ring.head + ring.count)) T(std::forward<U>(u)...);
+		++ring.count;
+		notify = m_waiters > 0;
+	}
+	if (notify) { m_cv.notify_all(); }
+	return true;
+}
+
+template <typename T>
+std::optional<T> rt_queue<T>::try_pop(queue_id qid) noexcept {
+	assert(qid < m_qcount);
+	std::unique_lock lock(m_mutex, std::try_to_lock);
+	if (!lock || !m_active || m_rings[qid].count == 0) { return std::nullopt; }
+	return take(qid);
+}
+
+template <typename T>
+std::optional<T> rt_queue<T>::pop(queue_id qid) {
+	assert(qid < m_qcount);
+	std::unique_lock lock(m_mutex);
+	auto const wake = [this, qid]() { return !m_active || m_rings[qid].count > 0; };
+	if (!wake()) {
+		++m_waiters;
+		m_cv.wait(lock, wake);
+		--m_waiters;
+	}
+	if (!m_active) { return std::nullopt; }
+	return take(qid);
+}
+
+template <typename T>
+std::size_t rt_queue<T>::size(queue_id qid) const {
+	assert(qid < m_qcount);
+	std::scoped_lock lock(m_mutex);
+	return m_rings[qid].count;
+}
+
+template <typename T>
+bool rt_queue<T>::active() const {
+	std::scoped_lock lock(m_mutex);
+	return m_active;
+}
+
+template <typename T>
+void rt_queue<T>::active(bool set) {
+	{
+		std::scoped_lock lock(m_mutex);
+		m_active = set;
+	}
+	m_cv.notify_all();
+}
+
+template <typename T>
+T rt_queue<T>::take(queue_id qid) noexcept {
+	ring_t& ring = m_rings[qid];
+	T* const t = slot(qid, ring.head);
+	T ret = std::move(*t);
+	t->~T();
+	ring.head = (ring.head + 1) % m_capacity;
+	--ring.count;
+	return ret;
+}
+} // namespace kt
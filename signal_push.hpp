@@ -0,0 +1,160 @@
+// KT header-only library
+// Requirements: C++17, Linux
+//
+// Features:
+// 	- Async-signal-safe push into an async_queue qid (usable from signal / crash handlers)
+// 	- Lock-free, allocation-free bounded ring (preallocated at construction)
+// 	- eventfd wakeup of a pump thread that forwards items to the queue in batches
+// 	- Consumers use the queue's normal pop API
+//
+// Guarantees of signal_pusher::push() (checked by tests/signal_push.cpp):
+// 	- Only lock-free atomics (checked at compile time) and one write(2) are used; errno is preserved
+// 	- No allocation, no locks: safe when the interrupted thread is itself inside push() / holds any lock
+// 	- Never blocks: returns false (and counts a drop) when the ring is full
+// 	- Items pushed by one thread are popped in that order; relative to ordinary pushes, order is unspecified
+//
+
+#pragma once
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <sys/eventfd.h>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <unistd.h>
+#include <vector>
+
+namespace kt {
+///
+/// \brief Async-signal-safe producer for a Queue qid
+/// \param Queue async_queue type (value_type must be trivially copyable)
+///
+template <typename Queue>
+class signal_pusher {
+  public:
+	using value_type = typename Queue::value_type;
+	using queue_id = typename Queue::queue_id;
+
+	static_assert(std::is_trivially_copyable_v<value_type>, "Items pushed from signal handlers must be trivially copyable");
+	static_assert(std::atomic<std::size_t>::is_always_lock_free && std::atomic<std::uint64_t>::is_always_lock_free, "Lock-free atomics required");
+
+	///
+	/// \brief Preallocate a ring of (at least) capacity items and start the pump thread
+	/// Throws std::system_error if the eventfd cannot be created
+	///
+	signal_pusher(Queue& queue, queue_id qid, std::size_t capacity);
+	~signal_pusher() noexcept;
+
+	signal_pusher(signal_pusher const&) = delete;
+	signal_pusher& operator=(signal_pusher const&) = delete;
+
+	///
+	/// \brief Copy t into the ring and wake the pump (async-signal-safe)
+	/// \returns false if the ring is full (t is dropped)
+	///
+	bool push(value_type const& t) noexcept;
+	///
+	/// \brief Obtain the number of items dropped because the ring was full
+	///
+	std::uint64_t dropped() const noexcept { return m_dropped.load(std::memory_order_relaxed); }
+	std::size_t capacity() const noexcept { return m_mask + 1; }
+
+  private:
+	// bounded MPMC ring (per-slot sequence numbers); only the pump consumes
+	struct slot_t {
+		std::atomic<std::size_t> seq;
+		value_type value;
+	};
+
+	void run();
+	bool take(std::vector<value_type>& out);
+
+	Queue& m_queue;
+	std::unique_ptr<slot_t[]> m_slots;
+	std::size_t m_mask{};
+	alignas(64) std::atomic<std::size_t> m_tail{};
+	alignas(64) std::size_t m_head{};
+	std::atomic<std::uint64_t> m_dropped{};
+	std::atomic<bool> m_stop{};
+	queue_id m_qid;
+	int m_fd{-1};
+	std::thread m_thread;
+};
+
+template <typename Queue>
+signal_pusher<Queue>::signal_pusher(Queue& queue, queue_id qid, std::size_t capacity) : m_queue(queue), m_qid(qid) {
+	std::size_t size = 1;
+	while (size < capacity) { size *= 2; }
+	m_slots = std::make_unique<slot_t[]>(size);
+	for (std::size_t i = 0; i < size; ++i) { m_slots[i].seq.store(i, std::memory_order_relaxed); }
+	m_mask = size - 1;
+	m_fd = ::eventfd(0, EFD_CLOEXEC);
+	if (m_fd < 0) { throw std::system_error(errno, std::generic_category(), "eventfd"); }
+	m_thread = std::thread([this]() { run(); });
+}
+
+template <typename Queue>
+signal_pusher<Queue>::~signal_pusher() noexcept {
+	m_stop = true;
+	::eventfd_write(m_fd, 1);
+	m_thread.join();
+	::close(m_fd);
+}
+
+template <typename Queue>
+bool signal_pusher<Queue>::push(value_type const& t) noexcept {
+	std::size_t pos = m_tail.load(std::memory_order_relaxed);
+	for (;;) {
+		slot_t& slot = m_slots[pos & m_mask];
+		std::size_t const seq = slot.seq.load(std::memory_order_acquire);
+		auto const diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+		if (diff == 0) {
+			if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+				slot.value = t;
+				slot.seq.store(pos + 1, std::memory_order_release);
+				break;
+			}
+		} else if (diff < 0) {
+			m_dropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		} else {
+			pos = m_tail.load(std::memory_order_relaxed);
+		}
+	}
+	int const saved = errno;
+	std::uint64_t const one = 1;
+	[[maybe_unused]] auto const written = ::write(m_fd, &one, sizeof(one));
+	errno = saved;
+	return true;
+}
+
+template <typename Queue>
+bool signal_pusher<Queue>::take(std::vector<value_type>& out) {
+	slot_t& slot = m_slots[m_head & m_mask];
+	if (slot.seq.load(std::memory_order_acquire) != m_head + 1) { return false; }
+	out.push_back(slot.value);
+	slot.seq.store(m_head + m_mask + 1, std::memory_order_release);
+	++m_head;
+	return true;
+}
+
+template <typename Queue>
+void signal_pusher<Queue>::run() {
+	std::vector<value_type> batch;
+	batch.reserve(capacity());
+	for (;;) {
+		eventfd_t count{};
+		// read resets the counter: every push after this point signals again
+		if (::eventfd_read(m_fd, &count) != 0 && errno != EINTR) { return; }
+		while (take(batch)) {}
+		if (!batch.empty()) {
+			m_queue.push(std::move(batch), m_qid);
+			batch.clear();
+		}
+		if (m_stop.load()) { return; }
+	}
+}
+} // namespace kt
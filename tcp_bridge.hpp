@@ -0,0 +1,519 @@
+// KT header-only library
+// Requirements: C++17, POSIX sockets
+//
+// Features:
+// 	- Forward items from an async_queue qid to an async_queue in another process over TCP
+// 	- Batching: everything queued (up to credit / batch limits) goes out in one frame
+// 	- Gather writes: frame headers and item bytes go out in one sendmsg (writev semantics, no SIGPIPE), without an intermediate buffer
+// 	- Credit-based flow control: the receiver grants credits as it pushes items into its queue
+// 	- Frame size limit shared by both ends: batches are split to fit, oversized items are rejected by the sender
+// 	- TCP_NODELAY (batching is done by the bridge, not by Nagle)
+//
+
+#pragma once
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <optional>
+#include <string>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace kt {
+///
+/// \brief Converts items to / from the bytes sent over a bridge
+///
+/// encode() must return a view into the item itself (it is sent in place, while the item is alive).
+/// decode() returns std::nullopt for bytes that are not a valid item (the receiver then drops the connection).
+/// Specialize for other types.
+///
+template <typename T, typename = void>
+struct bridge_codec;
+
+///
+/// \brief Bytes of an encoded item
+///
+struct bridge_bytes {
+	void const* data{};
+	std::size_t size{};
+};
+
+template <typename T>
+struct bridge_codec<T, std::enable_if_t<std::is_trivially_copyable_v<T>>> {
+	static bridge_bytes encode(T const& t) noexcept { return {&t, sizeof(T)}; }
+	static std::optional<T> decode(std::byte const* data, std::size_t size) noexcept {
+		if (size != sizeof(T)) { return std::nullopt; }
+		T ret;
+		std::memcpy(&ret, data, sizeof(T));
+		return ret;
+	}
+};
+
+template <>
+struct bridge_codec<std::string> {
+	static bridge_bytes encode(std::string const& t) noexcept { return {t.data(), t.size()}; }
+	static std::optional<std::string> decode(std::byte const* data, std::size_t size) { return std::string(reinterpret_cast<char const*>(data), size); }
+};
+
+template <>
+struct bridge_codec<std::vector<std::byte>> {
+	static bridge_bytes encode(std::vector<std::byte> const& t) noexcept { return {t.data(), t.size()}; }
+	static std::optional<std::vector<std::byte>> decode(std::byte const* data, std::size_t size) { return std::vector<std::byte>(data, data + size); }
+};
+
+namespace detail {
+///
+/// \brief Owning socket descriptor
+///
+class socket_fd {
+  public:
+	socket_fd() = default;
+	explicit socket_fd(int fd) noexcept : m_fd(fd) {}
+	socket_fd(socket_fd&& rhs) noexcept : m_fd(std::exchange(rhs.m_fd, -1)) {}
+	socket_fd& operator=(socket_fd&& rhs) noexcept {
+		if (&rhs != this) {
+			reset();
+			m_fd = std::exchange(rhs.m_fd, -1);
+		}
+		return *this;
+	}
+	~socket_fd() noexcept { reset(); }
+
+	void reset() noexcept {
+		if (m_fd >= 0) { ::close(std::exchange(m_fd, -1)); }
+	}
+	void shutdown() const noexcept {
+		if (m_fd >= 0) { ::shutdown(m_fd, SHUT_RDWR); }
+	}
+	// close with RST (SO_LINGER 0): a peer blocked in send() fails instead of waiting for reads that never come
+	void abort() noexcept {
+		if (m_fd < 0) { return; }
+		linger const now{1, 0};
+		::setsockopt(m_fd, SOL_SOCKET, SO_LINGER, &now, sizeof(now));
+		reset();
+	}
+	int get() const noexcept { return m_fd; }
+
+  private:
+	int m_fd = -1;
+};
+
+[[noreturn]] inline void throw_errno(char const* what) { throw std::system_error(errno, std::generic_category(), what); }
+
+inline void no_delay(int fd) {
+	int const on = 1;
+	if (::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on)) != 0) { throw_errno("setsockopt(TCP_NODELAY)"); }
+}
+
+inline sockaddr_in make_address(std::string const& host, std::uint16_t port) {
+	sockaddr_in ret{};
+	ret.sin_family = AF_INET;
+	ret.sin_port = htons(port);
+	if (::inet_pton(AF_INET, host.c_str(), &ret.sin_addr) != 1) { throw std::system_error(std::make_error_code(std::errc::invalid_argument), "inet_pton"); }
+	return ret;
+}
+
+inline bool read_exact(int fd, void* out, std::size_t size) noexcept {
+	auto* bytes = static_cast<char*>(out);
+	while (size > 0) {
+		ssize_t const n = ::recv(fd, bytes, size, 0);
+		if (n < 0 && errno == EINTR) { continue; }
+		if (n <= 0) { return false; }
+		bytes += n;
+		size -= static_cast<std::size_t>(n);
+	}
+	return true;
+}
+
+inline bool write_exact(int fd, void const* data, std::size_t size) noexcept {
+	auto const* bytes = static_cast<char const*>(data);
+	while (size > 0) {
+		ssize_t const n = ::send(fd, bytes, size, MSG_NOSIGNAL);
+		if (n < 0 && errno == EINTR) { continue; }
+		if (n <= 0) { return false; }
+		bytes += n;
+		size -= static_cast<std::size_t>(n);
+	}
+	return true;
+}
+
+// writes all of iov (modifies it to track partial writes)
+inline bool write_all(int fd, iovec* iov, std::size_t count) noexcept {
+	while (count > 0) {
+		msghdr msg{};
+		msg.msg_iov = iov;
+		msg.msg_iovlen = std::min<std::size_t>(count, IOV_MAX);
+		ssize_t n = ::sendmsg(fd, &msg, MSG_NOSIGNAL);
+		if (n < 0 && errno == EINTR) { continue; }
+		if (n <= 0) { return false; }
+		while (count > 0 && static_cast<std::size_t>(n) >= iov->iov_len) {
+			n -= static_cast<ssize_t>(iov->iov_len);
+			++iov;
+			--count;
+		}
+		if (count > 0) {
+			iov->iov_base = static_cast<char*>(iov->iov_base) + n;
+			iov->iov_len -= static_cast<std::size_t>(n);
+		}
+	}
+	return true;
+}
+
+// frame: [count, bytes] then count * [size, payload]; all integers are 32 bit network order
+struct frame_header {
+	std::uint32_t count;
+	std::uint32_t bytes;
+};
+
+// payload bytes (size prefixes + items) allowed in one frame unless configured otherwise; must match on both ends
+inline constexpr std::uint32_t default_max_frame = 64u << 20;
+// smallest usable limit: one size prefix and a few bytes of item
+inline constexpr std::uint32_t min_max_frame = 64;
+} // namespace detail
+
+///
+/// \brief Pops items from a qid and streams them to a tcp_bridge_receiver
+/// \param Queue async_queue type
+/// \param Codec bridge_codec for Queue::value_type
+///
+/// Forwarding stops once the queue is deactivated or the connection is closed; the destructor waits for that
+/// (a sender blocked in pop() on an empty, active queue keeps waiting: deactivate the queue first).
+/// Items popped before a connection failure are lost.
+/// Batches are split into frames of at most max_frame payload bytes (must not exceed the receiver's max_frame);
+/// an item that cannot fit a frame on its own is dropped and counted in rejected().
+///
+template <typename Queue, typename Codec = bridge_codec<typename Queue::value_type>>
+class tcp_bridge_sender {
+  public:
+	using value_type = typename Queue::value_type;
+	using queue_id = typename Queue::queue_id;
+
+	///
+	/// \brief Maximum items per frame
+	///
+	static constexpr std::size_t default_max_batch = 256;
+	///
+	/// \brief Default limit on the payload bytes of one frame
+	///
+	static constexpr std::uint32_t default_max_frame = detail::default_max_frame;
+
+	///
+	/// \brief Connect to a receiver and start forwarding qid
+	/// \param host IPv4 address (eg "127.0.0.1")
+	/// Throws std::system_error on failure
+	///
+	tcp_bridge_sender(Queue& queue, queue_id qid, std::string const& host, std::uint16_t port, std::size_t max_batch = default_max_batch,
+					  std::uint32_t max_frame = default_max_frame);
+	~tcp_bridge_sender() noexcept;
+
+	tcp_bridge_sender(tcp_bridge_sender const&) = delete;
+	tcp_bridge_sender& operator=(tcp_bridge_sender const&) = delete;
+
+	///
+	/// \brief Obtain the number of items written to the connection
+	///
+	std::uint64_t sent() const noexcept { return m_sent.load(std::memory_order_relaxed); }
+	///
+	/// \brief Obtain the number of items dropped for being too large for a frame
+	///
+	std::uint64_t rejected() const noexcept { return m_rejected.load(std::memory_order_relaxed); }
+	///
+	/// \brief Check whether the sender is still forwarding
+	///
+	bool connected() const noexcept { return m_connected.load(); }
+
+  private:
+	void run();
+	bool receive_credits(bool wait);
+	bool send(std::vector<value_type> const& batch);
+	bool flush(std::size_t count, std::uint32_t bytes);
+
+	Queue& m_queue;
+	Queue m_staging; // items moved out of m_queue in one transfer (beyond the first popped one)
+	std::vector<std::uint32_t> m_sizes;
+	std::vector<iovec> m_iov;
+	detail::socket_fd m_socket;
+	std::uint64_t m_credits{};
+	std::uint32_t m_partial{}; // credit message bytes received so far
+	std::size_t m_partial_size{};
+	std::size_t m_max_batch;
+	std::uint32_t m_max_frame;
+	queue_id m_qid;
+	std::atomic<std::uint64_t> m_sent{};
+	std::atomic<std::uint64_t> m_rejected{};
+	std::atomic<bool> m_connected{true};
+	std::thread m_thread;
+};
+
+///
+/// \brief Accepts one tcp_bridge_sender connection and pushes received items into a qid
+/// \param Queue async_queue type
+/// \param Codec bridge_codec for Queue::value_type
+///
+/// Credits are returned only after a batch has been pushed: with blocking byte limits on the queue,
+/// a full queue stops the sender (deactivate the queue to unblock the destructor in that case).
+/// A malformed frame (or one larger than max_frame bytes) resets the connection, failing the sender; so does an exception
+/// while receiving.
+///
+template <typename Queue, typename Codec = bridge_codec<typename Queue::value_type>>
+class tcp_bridge_receiver {
+  public:
+	using value_type = typename Queue::value_type;
+	using queue_id = typename Queue::queue_id;
+
+	///
+	/// \brief Default number of items the sender may have outstanding
+	///
+	static constexpr std::uint32_t default_window = 4096;
+	///
+	/// \brief Default limit on the payload bytes of one frame
+	///
+	static constexpr std::uint32_t default_max_frame = detail::default_max_frame;
+
+	///
+	/// \brief Listen on port (0: pick an ephemeral port, see port()) and start accepting
+	/// \param host IPv4 address to bind to
+	/// \param max_frame Largest frame payload accepted (checked before anything is allocated for it)
+	/// Throws std::system_error on failure
+	///
+	tcp_bridge_receiver(Queue& queue, queue_id qid, std::uint16_t port = 0, std::string const& host = "127.0.0.1", std::uint32_t window = default_window,
+						std::uint32_t max_frame = default_max_frame);
+	~tcp_bridge_receiver() noexcept;
+
+	tcp_bridge_receiver(tcp_bridge_receiver const&) = delete;
+	tcp_bridge_receiver& operator=(tcp_bridge_receiver const&) = delete;
+
+	///
+	/// \brief Obtain the bound port
+	///
+	std::uint16_t port() const noexcept { return m_port; }
+	///
+	/// \brief Obtain the number of items pushed into the queue
+	///
+	std::uint64_t received() const noexcept { return m_received.load(std::memory_order_relaxed); }
+
+  private:
+	void run() noexcept;
+	bool receive();
+	bool grant(std::uint32_t credits) noexcept;
+
+	Queue& m_queue;
+	detail::socket_fd m_listener;
+	detail::socket_fd m_socket;
+	std::atomic<int> m_connection{-1};
+	std::atomic<std::uint64_t> m_received{};
+	std::atomic<bool> m_stop{};
+	queue_id m_qid;
+	std::uint32_t m_window;
+	std::uint32_t m_max_frame;
+	std::uint16_t m_port{};
+	std::thread m_thread;
+};
+
+template <typename Queue, typename Codec>
+tcp_bridge_sender<Queue, Codec>::tcp_bridge_sender(Queue& queue, queue_id qid, std::string const& host, std::uint16_t port, std::size_t max_batch,
+												  std::uint32_t max_frame)
+	: m_queue(queue), m_max_batch(std::max<std::size_t>(max_batch, 1)), m_max_frame(std::max(max_frame, detail::min_max_frame)), m_qid(qid) {
+	sockaddr_in const address = detail::make_address(host, port);
+	m_socket = detail::socket_fd(::socket(AF_INET, SOCK_STREAM, 0));
+	if (m_socket.get() < 0) { detail::throw_errno("socket"); }
+	detail::no_delay(m_socket.get());
+	if (::connect(m_socket.get(), reinterpret_cast<sockaddr const*>(&address), sizeof(address)) != 0) { detail::throw_errno("connect"); }
+	m_thread = std::thread([this]() { run(); });
+}
+
+template <typename Queue, typename Codec>
+tcp_bridge_sender<Queue, Codec>::~tcp_bridge_sender() noexcept {
+	m_socket.shutdown();
+	m_thread.join();
+}
+
+template <typename Queue, typename Codec>
+void tcp_bridge_sender<Queue, Codec>::run() {
+	std::vector<value_type> batch;
+	for (;;) {
+		// top up credits without blocking; block only when none are left
+		if (!receive_credits(m_credits == 0)) { break; }
+		auto first = m_queue.pop(m_qid);
+		if (!first) { break; }
+		batch.clear();
+		batch.push_back(std::move(*first));
+		std::size_t const room = static_cast<std::size_t>(std::min<std::uint64_t>(m_credits, m_max_batch)) - 1;
+		if (room > 0 && m_queue.transfer(m_qid, m_staging, 0, room) > 0) {
+			for (auto& t : m_staging.clear(true)) { batch.push_back(std::move(t)); }
+		}
+		bool const sent = send(batch);
+		m_queue.done();
+		if (!sent) { break; }
+	}
+	m_connected = false;
+}
+
+template <typename Queue, typename Codec>
+bool tcp_bridge_sender<Queue, Codec>::receive_credits(bool wait) {
+	for (;;) {
+		std::byte buffer[256];
+		std::memcpy(buffer, &m_partial, m_partial_size);
+		ssize_t const n = ::recv(m_socket.get(), buffer + m_partial_size, sizeof(buffer) - m_partial_size, wait ? 0 : MSG_DONTWAIT);
+		if (n < 0 && errno == EINTR) { continue; }
+		if (n < 0 && !wait && (errno == EAGAIN || errno == EWOULDBLOCK)) { return true; }
+		if (n <= 0) { return false; }
+		std::size_t const total = m_partial_size + static_cast<std::size_t>(n);
+		std::size_t offset = 0;
+		for (; offset + sizeof(std::uint32_t) <= total; offset += sizeof(std::uint32_t)) {
+			std::uint32_t credit;
+			std::memcpy(&credit, buffer + offset, sizeof(credit));
+			m_credits += ntohl(credit);
+		}
+		m_partial_size = total - offset;
+		std::memcpy(&m_partial, buffer + offset, m_partial_size);
+		if (m_credits > 0) { wait = false; }
+	}
+}
+
+template <typename Queue, typename Codec>
+bool tcp_bridge_sender<Queue, Codec>::send(std::vector<value_type> const& batch) {
+	// items of the frame being built occupy m_sizes[2..] / m_iov[1..]; a full frame is flushed and the slots reused
+	m_sizes.resize(2 + batch.size());
+	m_iov.resize(1 + 2 * batch.size());
+	std::size_t count{};
+	std::uint32_t bytes{};
+	for (value_type const& t : batch) {
+		bridge_bytes const item = Codec::encode(t);
+		if (item.size > m_max_frame - sizeof(std::uint32_t)) {
+			m_rejected.fetch_add(1, std::memory_order_relaxed);
+			continue;
+		}
+		std::uint32_t const framed = static_cast<std::uint32_t>(sizeof(std::uint32_t) + item.size);
+		if (framed > m_max_frame - bytes) {
+			if (!flush(count, bytes)) { return false; }
+			count = 0;
+			bytes = 0;
+		}
+		m_sizes[2 + count] = htonl(static_cast<std::uint32_t>(item.size));
+		m_iov[1 + 2 * count] = {&m_sizes[2 + count], sizeof(std::uint32_t)};
+		m_iov[2 + 2 * count] = {const_cast<void*>(item.data), item.size};
+		bytes += framed;
+		++count;
+	}
+	return count == 0 || flush(count, bytes);
+}
+
+template <typename Queue, typename Codec>
+bool tcp_bridge_sender<Queue, Codec>::flush(std::size_t count, std::uint32_t bytes) {
+	m_sizes[0] = htonl(static_cast<std::uint32_t>(count));
+	m_sizes[1] = htonl(bytes);
+	m_iov[0] = {m_sizes.data(), sizeof(detail::frame_header)};
+	if (!detail::write_all(m_socket.get(), m_iov.data(), 1 + 2 * count)) { return false; }
+	m_credits -= count;
+	m_sent.fetch_add(count, std::memory_order_relaxed);
+	return true;
+}
+
+template <typename Queue, typename Codec>
+tcp_bridge_receiver<Queue, Codec>::tcp_bridge_receiver(Queue& queue, queue_id qid, std::uint16_t port, std::string const& host, std::uint32_t window,
+														std::uint32_t max_frame)
+	: m_queue(queue), m_qid(qid), m_window(std::max<std::uint32_t>(window, 1)), m_max_frame(std::max(max_frame, detail::min_max_frame)) {
+	sockaddr_in address = detail::make_address(host, port);
+	m_listener = detail::socket_fd(::socket(AF_INET, SOCK_STREAM, 0));
+	if (m_listener.get() < 0) { detail::throw_errno("socket"); }
+	int const on = 1;
+	::setsockopt(m_listener.get(), SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+	if (::bind(m_listener.get(), reinterpret_cast<sockaddr const*>(&address), sizeof(address)) != 0) { detail::throw_errno("bind"); }
+	if (::listen(m_listener.get(), 1) != 0) { detail::throw_errno("listen"); }
+	socklen_t length = sizeof(address);
+	if (::getsockname(m_listener.get(), reinterpret_cast<sockaddr*>(&address), &length) != 0) { detail::throw_errno("getsockname"); }
+	m_port = ntohs(address.sin_port);
+	m_thread = std::thread([this]() { run(); });
+}
+
+template <typename Queue, typename Codec>
+tcp_bridge_receiver<Queue, Codec>::~tcp_bridge_receiver() noexcept {
+	m_stop = true;
+	// unblocks accept() / recv() on the bridge thread
+	m_listener.shutdown();
+	// exchange: exactly one of this and the bridge thread (on a failed connection) gets to touch the descriptor
+	if (int const fd = m_connection.exchange(-1); fd >= 0) { ::shutdown(fd, SHUT_RDWR); }
+	m_thread.join();
+}
+
+template <typename Queue, typename Codec>
+void tcp_bridge_receiver<Queue, Codec>::run() noexcept {
+	bool clean = false;
+	try {
+		clean = receive();
+	} catch (...) {
+		// eg bad_alloc / a throwing decode or push: drop the connection rather than terminate
+	}
+	if (clean) { return; }
+	// reset rather than shutdown: a sender blocked writing the rest of a rejected frame sees an error instead of hanging
+	// (unless the destructor already claimed the descriptor; it is closed after join() then)
+	if (m_connection.exchange(-1) >= 0) { m_socket.abort(); }
+}
+
+template <typename Queue, typename Codec>
+bool tcp_bridge_receiver<Queue, Codec>::receive() {
+	int fd = -1;
+	do {
+		fd = ::accept(m_listener.get(), nullptr, nullptr);
+	} while (fd < 0 && errno == EINTR && !m_stop);
+	if (fd < 0) { return true; }
+	m_socket = detail::socket_fd(fd);
+	m_connection = fd;
+	// the destructor may have missed the connection while it was being accepted
+	if (m_stop) { return true; }
+	int const on = 1;
+	::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+	if (!grant(m_window)) { return true; }
+	std::vector<std::byte> payload;
+	std::vector<value_type> batch;
+	detail::frame_header header;
+	while (detail::read_exact(fd, &header, sizeof(header))) {
+		std::uint32_t const count = ntohl(header.count);
+		std::uint32_t const bytes = ntohl(header.bytes);
+		// every item carries a size prefix: validate both before allocating anything for the frame
+		if (bytes > m_max_frame || count > bytes / sizeof(std::uint32_t)) { return false; }
+		payload.resize(bytes);
+		if (!detail::read_exact(fd, payload.data(), payload.size())) { break; }
+		batch.clear();
+		batch.reserve(count);
+		std::size_t offset = 0;
+		for (std::uint32_t i = 0; i < count; ++i) {
+			std::uint32_t size;
+			if (offset + sizeof(size) > payload.size()) { return false; }
+			std::memcpy(&size, payload.data() + offset, sizeof(size));
+			offset += sizeof(size);
+			size = ntohl(size);
+			if (size > payload.size() - offset) { return false; }
+			auto item = Codec::decode(payload.data() + offset, size);
+			if (!item) { return false; }
+			batch.push_back(std::move(*item));
+			offset += size;
+		}
+		if (offset != payload.size()) { return false; }
+		m_queue.push(std::move(batch), m_qid);
+		m_received.fetch_add(count, std::memory_order_relaxed);
+		if (!grant(count)) { break; }
+	}
+	return true;
+}
+
+template <typename Queue, typename Codec>
+bool tcp_bridge_receiver<Queue, Codec>::grant(std::uint32_t credits) noexcept {
+	std::uint32_t const message = htonl(credits);
+	return detail::write_exact(m_socket.get(), &message, sizeof(message));
+}
+} // namespace kt
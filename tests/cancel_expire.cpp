@@ -0,0 +1,37 @@
+// Cancel-then-expire check for async_queue.hpp: items cancelled behind the front of a TTL queue must be discarded
+// when the items ahead of them expire, never handed to the on_expired callback.
+//
+// Build: g++ -std=c++17 -O1 -g -fsanitize=address,undefined -pthread tests/cancel_expire.cpp && ./a.out
+
+#include "../async_queue.hpp"
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+int main() {
+	constexpr int count = 10;
+	kt::async_queue<int> queue;
+	std::vector<int> expired;
+	queue.expire_after(0, std::chrono::milliseconds(10), [&expired](int&& i) { expired.push_back(i); });
+	std::vector<kt::async_queue<int>::item_handle> handles;
+	for (int i = 0; i < count; ++i) { handles.push_back(queue.push_cancellable(int(i))); }
+	// odd items are tombstones behind a live front
+	for (int i = 1; i < count; i += 2) { queue.cancel(handles[static_cast<std::size_t>(i)]); }
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	bool ok = !queue.try_pop().has_value();
+	for (int i : expired) {
+		if (i % 2 != 0) {
+			std::printf("cancelled item %d reported as expired\n", i);
+			ok = false;
+		}
+	}
+	auto const stats = queue.stats(0);
+	if (expired.size() != count / 2 || stats.expired != count / 2 || stats.removed != count / 2) {
+		std::printf("expired %zu (stats %llu), removed %llu\n", expired.size(), static_cast<unsigned long long>(stats.expired),
+					static_cast<unsigned long long>(stats.removed));
+		ok = false;
+	}
+	std::printf("%s\n", ok ? "ok" : "FAILED");
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,43 @@
+// Completion check for dag_executor.hpp: run() called back to back on small graphs, so that run() returns (and its job
+// goes out of scope) while the worker that completed the last node may still be signalling it.
+// Every node must run exactly once, after its predecessors; TSan / ASan must stay quiet.
+//
+// Build: g++ -std=c++17 -O1 -g -fsanitize=thread -pthread tests/dag_executor_run.cpp && ./a.out (or -fsanitize=address,undefined)
+
+#include "../dag_executor.hpp"
+#include <atomic>
+#include <cstdio>
+#include <vector>
+
+int main() {
+	constexpr int iterations = 20000;
+	kt::dag_executor executor(4);
+	bool ok = true;
+	for (int i = 0; i < iterations && ok; ++i) {
+		// 1 to 4 nodes: a chain when i is even, independent nodes otherwise
+		auto const count = static_cast<kt::task_graph::node_id>(1 + i % 4);
+		kt::task_graph graph(count);
+		if (i % 2 == 0) {
+			for (kt::task_graph::node_id n = 1; n < count; ++n) { graph.add_edge(n - 1, n); }
+		}
+		std::vector<std::atomic<int>> runs(count);
+		std::atomic<int> order{};
+		std::vector<int> position(count);
+		executor.run(graph, [&](kt::task_graph::node_id node) {
+			position[node] = order++;
+			++runs[node];
+		});
+		for (kt::task_graph::node_id n = 0; n < count; ++n) {
+			if (runs[n].load() != 1) {
+				std::printf("iteration %d: node %u ran %d times\n", i, n, runs[n].load());
+				ok = false;
+			}
+			if (i % 2 == 0 && n > 0 && position[n] < position[n - 1]) {
+				std::printf("iteration %d: node %u ran before its predecessor\n", i, n);
+				ok = false;
+			}
+		}
+	}
+	std::printf("%s\n", ok ? "ok" : "FAILED");
+	return ok ? 0 : 1;
+}
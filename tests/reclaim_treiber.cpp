@@ -0,0 +1,72 @@
+// Treiber stack check for reclaim.hpp: concurrent push / pop with every popped node retired through the reclaimer.
+// Every pushed value must be popped exactly once and every node freed (no leak, no use after free under ASan / TSan).
+//
+// Build: g++ -std=c++17 -O1 -g -fsanitize=address,undefined -pthread tests/reclaim_treiber.cpp && ./a.out (or -fsanitize=thread)
+
+#include "../reclaim.hpp"
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace {
+std::atomic<long> g_live{};
+
+struct node_t {
+	explicit node_t(long value) : value(value) { ++g_live; }
+	~node_t() { --g_live; }
+
+	long value;
+	node_t* next{};
+};
+
+template <typename Reclaimer>
+bool run(char const* name) {
+	constexpr int threads = 8;
+	constexpr int per_thread = 20000;
+	long sum{};
+	long popped{};
+	{
+		Reclaimer reclaimer;
+		std::atomic<node_t*> head{};
+		std::atomic<long> thread_sum{};
+		std::atomic<long> thread_popped{};
+		std::vector<std::thread> workers;
+		for (int t = 0; t < threads; ++t) {
+			workers.emplace_back([&, t]() {
+				for (int i = 0; i < per_thread; ++i) {
+					auto* n = new node_t(t * per_thread + i);
+					n->next = head.load();
+					while (!head.compare_exchange_weak(n->next, n)) {}
+					auto guard = reclaimer.pin();
+					node_t* top = guard.protect(head);
+					while (top && !head.compare_exchange_strong(top, top->next)) { top = guard.protect(head); }
+					if (!top) { continue; }
+					thread_sum += top->value;
+					++thread_popped;
+					guard.retire(top);
+				}
+			});
+		}
+		for (auto& worker : workers) { worker.join(); }
+		sum = thread_sum;
+		popped = thread_popped;
+		while (node_t* top = head.load()) {
+			head = top->next;
+			sum += top->value;
+			++popped;
+			delete top;
+		}
+	}
+	long const total = long(threads) * per_thread;
+	bool const ret = popped == total && sum == total * (total - 1) / 2 && g_live == 0;
+	std::printf("%s: popped %ld / %ld, live nodes %ld: %s\n", name, popped, total, g_live.load(), ret ? "ok" : "FAILED");
+	return ret;
+}
+} // namespace
+
+int main() {
+	bool ok = run<kt::reclaimer<kt::epoch_based>>("epoch_based");
+	ok &= run<kt::reclaimer<kt::hazard_pointers<1>>>("hazard_pointers");
+	return ok ? 0 : 1;
+}
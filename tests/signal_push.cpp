@@ -0,0 +1,132 @@
+// Signal handler check for signal_push.hpp: SIGUSR1 handlers push into a signal_pusher while the interrupted threads
+// are busy in the queue (holding its lock) or inside push() themselves; signals come from raise() and pthread_kill().
+// Every handled signal must be popped or counted as dropped, items from one thread must arrive in order, and errno
+// must be left untouched by push().
+//
+// Build: g++ -std=c++17 -O1 -g -fsanitize=address,undefined -pthread tests/signal_push.cpp && ./a.out (or -fsanitize=thread)
+
+#include "../async_queue.hpp"
+#include "../signal_push.hpp"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <pthread.h>
+#include <thread>
+#include <vector>
+
+namespace {
+struct event_t {
+	int thread;
+	int seq;
+};
+
+using queue_t = kt::async_queue<event_t>;
+
+constexpr int workers = 4;
+constexpr int signals = 20000;
+
+kt::signal_pusher<queue_t>* g_pusher{};
+std::atomic<long> g_handled{};
+std::atomic<long> g_errno_changed{};
+std::atomic<long> g_plain_dropped{}; // pushes outside handlers that found the ring full
+thread_local int t_thread = -1;
+thread_local int t_seq{};
+
+extern "C" void on_signal(int) {
+	int const saved = errno;
+	errno = EILSEQ;
+	g_pusher->push({t_thread, t_seq++});
+	if (errno != EILSEQ) { g_errno_changed.fetch_add(1, std::memory_order_relaxed); }
+	g_handled.fetch_add(1, std::memory_order_relaxed);
+	errno = saved;
+}
+} // namespace
+
+int main() {
+	queue_t queue;
+	queue_t::queue_id const busy = queue.add_queue();
+	bool ok = true;
+	long popped{};
+	long dropped{};
+	std::vector<int> next(workers + 1);
+	{
+		kt::signal_pusher<queue_t> pusher(queue, 0, 1024);
+		g_pusher = &pusher;
+		struct sigaction action {};
+		action.sa_handler = &on_signal;
+		sigemptyset(&action.sa_mask);
+		action.sa_flags = SA_RESTART;
+		sigaction(SIGUSR1, &action, nullptr);
+
+		std::atomic<bool> stop{};
+		std::atomic<int> ready{};
+		std::vector<std::thread> threads;
+		for (int i = 0; i < workers; ++i) {
+			threads.emplace_back([&, i]() {
+				t_thread = i;
+				++ready;
+				// keep the thread inside the queue (and inside push() itself for odd workers) when the signal lands
+				while (!stop.load(std::memory_order_relaxed)) {
+					if (i % 2 == 0) {
+						queue.push(event_t{i, 0}, busy);
+						queue.try_pop(busy);
+					} else {
+						if (!pusher.push({-1, 0})) { g_plain_dropped.fetch_add(1, std::memory_order_relaxed); }
+						std::this_thread::yield();
+					}
+				}
+			});
+		}
+		while (ready.load() < workers) { std::this_thread::yield(); }
+		std::vector<pthread_t> handles;
+		for (auto& t : threads) { handles.push_back(t.native_handle()); }
+
+		// main raises at itself too, in between pthread_kill()s to the workers
+		t_thread = workers;
+		for (int i = 0; i < signals; ++i) {
+			if (i % 8 == 7) {
+				std::raise(SIGUSR1);
+			} else {
+				pthread_kill(handles[static_cast<std::size_t>(i) % handles.size()], SIGUSR1);
+			}
+			if (i % 64 == 0) { std::this_thread::yield(); }
+		}
+		// pending signals are delivered (or discarded) before a thread exits: only handled ones are counted
+		stop = true;
+		for (auto& t : threads) { t.join(); }
+		signal(SIGUSR1, SIG_IGN);
+
+		long const handled = g_handled.load();
+		auto const signal_drops = [&]() { return static_cast<long>(pusher.dropped()) - g_plain_dropped.load(); };
+		auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+		while (popped + signal_drops() < handled && std::chrono::steady_clock::now() < deadline) {
+			auto const event = queue.try_pop(0);
+			if (!event) {
+				std::this_thread::yield();
+				continue;
+			}
+			if (event->thread < 0) { continue; }
+			++popped;
+			auto& expected = next[static_cast<std::size_t>(event->thread)];
+			if (event->seq < expected) {
+				std::printf("thread %d: seq %d after %d\n", event->thread, event->seq, expected - 1);
+				ok = false;
+			}
+			expected = event->seq + 1;
+		}
+		dropped = signal_drops();
+		if (popped + dropped != handled) {
+			std::printf("handled %ld, popped %ld + dropped %ld\n", handled, popped, dropped);
+			ok = false;
+		}
+		if (g_errno_changed.load() > 0) {
+			std::printf("errno changed by %ld pushes\n", g_errno_changed.load());
+			ok = false;
+		}
+		g_pusher = nullptr;
+	}
+	std::printf("%s: %ld handled, %ld popped, %ld dropped\n", ok ? "ok" : "FAILED", g_handled.load(), popped, dropped);
+	return ok ? 0 : 1;
+}
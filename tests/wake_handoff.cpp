@@ -0,0 +1,59 @@
+// Wakeup handoff check for async_queue.hpp: a waiter signalled for one queue that takes from another must pass the
+// signal on. Consumer A (pop_any over {0, 1}, or pop_group over a group of both) parks first, consumer B (pop(1)) second;
+// push(x, 1) signals A, push(y, 0) finds A already signalled and wakes nobody; A takes y, so x must go to B.
+// (If A wakes between the pushes and takes x, B rightly keeps waiting on an empty queue 1: only a stranded x fails.)
+//
+// Build: g++ -std=c++17 -O1 -g -fsanitize=address,undefined -pthread tests/wake_handoff.cpp && ./a.out (or -fsanitize=thread)
+
+#include "../async_queue.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace {
+using queue_t = kt::async_queue<int>;
+
+constexpr int iterations = 50;
+constexpr auto settle = std::chrono::milliseconds(5);
+
+template <typename F>
+bool run(char const* name, F&& pop_first) {
+	int failed{};
+	for (int i = 0; i < iterations; ++i) {
+		queue_t queue(2);
+		auto const group = queue.add_group("both");
+		queue.attach(0, group);
+		queue.attach(1, group);
+		std::atomic<int> done{};
+		// threads park in start order (settle gives each time to block)
+		std::thread a([&]() {
+			if (pop_first(queue, group)) { ++done; }
+		});
+		std::this_thread::sleep_for(settle);
+		std::thread b([&]() {
+			if (queue.pop(1)) { ++done; }
+		});
+		std::this_thread::sleep_for(settle);
+		queue.push(1, 1);
+		queue.push(0, 0);
+		auto const deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(500);
+		while (done.load() < 2 && std::chrono::steady_clock::now() < deadline) { std::this_thread::sleep_for(std::chrono::milliseconds(1)); }
+		if (done.load() < 2 && queue.size(1) > 0) { ++failed; }
+		// releases a consumer that was never woken
+		queue.active(false);
+		a.join();
+		b.join();
+	}
+	std::printf("%s: %s (%d / %d stuck)\n", name, failed == 0 ? "ok" : "FAILED", failed, iterations);
+	return failed == 0;
+}
+} // namespace
+
+int main() {
+	bool ok = true;
+	ok &= run("pop_any", [](queue_t& queue, queue_t::group_id) { return queue.pop_any(std::vector<queue_t::queue_id>{0, 1}).has_value(); });
+	ok &= run("pop_group", [](queue_t& queue, queue_t::group_id group) { return queue.pop_group(group).has_value(); });
+	return ok ? 0 : 1;
+}
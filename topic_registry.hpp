@@ -0,0 +1,175 @@
+// KT header-only library
+// Requirements: C++17
+//
+// Features:
+// 	- Map string topic names to async_queue qids
+// 	- Lock-free lookup (open addressing table, grown by doubling on registration)
+// 	- Push by resolved topic handle (no string hashing on the hot path)
+//
+
+#pragma once
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace kt {
+///
+/// \brief Read-mostly registry of named topics, each backed by a queue of Queue
+/// \param Queue async_queue type
+///
+/// Lookups never take a lock: they probe the current table through atomic slots.
+/// Registration inserts into the current table in place; when it is half full a table of twice the size is
+/// built and published. Superseded tables are retained (lookups may still be probing them) until the registry
+/// is destroyed, but their total size is bounded by that of the current one: memory stays O(topics).
+///
+template <typename Queue>
+class topic_registry {
+  public:
+	using queue_type = Queue;
+	using queue_id = typename Queue::queue_id;
+
+	///
+	/// \brief Resolved topic handle
+	///
+	struct topic {
+		queue_id qid{};
+	};
+
+	explicit topic_registry(Queue& queue);
+
+	topic_registry(topic_registry const&) = delete;
+	topic_registry& operator=(topic_registry const&) = delete;
+
+	///
+	/// \brief Obtain the topic for name, adding a new queue for it if not registered
+	///
+	topic add(std::string_view name);
+	///
+	/// \brief Register name against an existing qid (replaces any previous mapping)
+	///
+	topic add(std::string_view name, queue_id qid);
+	///
+	/// \brief Obtain the topic for name, if registered (lock-free)
+	///
+	std::optional<topic> find(std::string_view name) const noexcept;
+	///
+	/// \brief Obtain the number of registered topics (lock-free)
+	///
+	std::size_t size() const noexcept { return m_size.load(std::memory_order_acquire); }
+
+	///
+	/// \brief Move a T to the back of topic's queue and notify
+	///
+	void push(typename Queue::value_type&& t, topic tp) { m_queue.push(std::move(t), tp.qid); }
+	///
+	/// \brief Copy a T to the back of topic's queue and notify
+	///
+	void push(typename Queue::value_type const& t, topic tp) { m_queue.push(t, tp.qid); }
+	///
+	/// \brief Pop a T from the front of topic's queue, wait until populated / not active
+	///
+	std::optional<typename Queue::value_type> pop(topic tp) { return m_queue.pop(tp.qid); }
+
+	Queue& queue() const noexcept { return m_queue; }
+
+  private:
+	struct entry_t {
+		entry_t(std::string_view name, std::size_t hash, queue_id qid) : name(name), hash(hash), qid(qid) {}
+
+		std::string const name;
+		std::size_t const hash;
+		std::atomic<queue_id> qid;
+	};
+
+	struct table_t {
+		explicit table_t(std::size_t capacity) : slots(std::make_unique<std::atomic<entry_t*>[]>(capacity)), mask(capacity - 1) {}
+
+		std::unique_ptr<std::atomic<entry_t*>[]> slots; // open addressing (linear probe); null if vacant
+		std::size_t mask;
+	};
+
+	static std::size_t hash(std::string_view name) noexcept { return std::hash<std::string_view>{}(name); }
+	static entry_t* probe(table_t const& table, std::string_view name, std::size_t hash) noexcept;
+	static void insert(table_t& table, entry_t* entry) noexcept;
+	topic append(std::string_view name, std::size_t hash, queue_id qid);
+
+	Queue& m_queue;
+	std::deque<entry_t> m_entries; // stable addresses, append only
+	std::vector<std::unique_ptr<table_t>> m_tables;
+	std::atomic<table_t*> m_current{};
+	std::atomic<std::size_t> m_size{};
+	std::mutex m_mutex;
+};
+
+template <typename Queue>
+topic_registry<Queue>::topic_registry(Queue& queue) : m_queue(queue) {
+	m_tables.push_back(std::make_unique<table_t>(2));
+	m_current.store(m_tables.back().get(), std::memory_order_release);
+}
+
+template <typename Queue>
+typename topic_registry<Queue>::topic topic_registry<Queue>::add(std::string_view name) {
+	std::scoped_lock lock(m_mutex);
+	std::size_t const h = hash(name);
+	if (entry_t* entry = probe(*m_current.load(std::memory_order_relaxed), name, h)) { return {entry->qid.load(std::memory_order_relaxed)}; }
+	return append(name, h, m_queue.add_queue());
+}
+
+template <typename Queue>
+typename topic_registry<Queue>::topic topic_registry<Queue>::add(std::string_view name, queue_id qid) {
+	std::scoped_lock lock(m_mutex);
+	std::size_t const h = hash(name);
+	if (entry_t* entry = probe(*m_current.load(std::memory_order_relaxed), name, h)) {
+		entry->qid.store(qid, std::memory_order_release);
+		return {qid};
+	}
+	return append(name, h, qid);
+}
+
+template <typename Queue>
+std::optional<typename topic_registry<Queue>::topic> topic_registry<Queue>::find(std::string_view name) const noexcept {
+	if (entry_t const* entry = probe(*m_current.load(std::memory_order_acquire), name, hash(name))) { return topic{entry->qid.load(std::memory_order_acquire)}; }
+	return std::nullopt;
+}
+
+template <typename Queue>
+typename topic_registry<Queue>::topic topic_registry<Queue>::append(std::string_view name, std::size_t hash, queue_id qid) {
+	entry_t* const entry = &m_entries.emplace_back(name, hash, qid);
+	table_t* table = m_current.load(std::memory_order_relaxed);
+	// keep load factor <= 0.5 so probes stay short and always terminate on a vacant slot
+	if (m_entries.size() * 2 > table->mask + 1) {
+		auto grown = std::make_unique<table_t>(2 * (table->mask + 1));
+		for (entry_t& e : m_entries) { insert(*grown, &e); }
+		m_tables.push_back(std::move(grown));
+		m_current.store(m_tables.back().get(), std::memory_order_release);
+	} else {
+		insert(*table, entry);
+	}
+	m_size.store(m_entries.size(), std::memory_order_release);
+	return {qid};
+}
+
+template <typename Queue>
+typename topic_registry<Queue>::entry_t* topic_registry<Queue>::probe(table_t const& table, std::string_view name, std::size_t hash) noexcept {
+	for (std::size_t slot = hash & table.mask;; slot = (slot + 1) & table.mask) {
+		entry_t* const entry = table.slots[slot].load(std::memory_order_acquire);
+		if (!entry) { return nullptr; }
+		if (entry->hash == hash && entry->name == name) { return entry; }
+	}
+}
+
+template <typename Queue>
+void topic_registry<Queue>::insert(table_t& table, entry_t* entry) noexcept {
+	std::size_t slot = entry->hash & table.mask;
+	while (table.slots[slot].load(std::memory_order_relaxed)) { slot = (slot + 1) & table.mask; }
+	// release: a lookup that observes the slot also observes the entry's name / qid
+	table.slots[slot].store(entry, std::memory_order_release);
+}
+} // namespace kt